@@ -0,0 +1,174 @@
+#include <cc/Reclaimer>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace cc {
+
+namespace {
+
+struct ReclaimerState
+{
+    void startThread()
+    {
+        stop_ = false;
+        thread_ = std::thread{[this]{ run(); }};
+    }
+
+    void stopThread()
+    {
+        if (!thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        wakeup_.notify_one();
+        thread_.join();
+    }
+
+    void run()
+    {
+        while (true) {
+            std::unique_lock<std::mutex> lock{mutex_};
+            wakeup_.wait(lock, [this]{ return stop_ || !queue_.empty(); });
+            if (queue_.empty()) break;
+            Reclaimer::Garbage garbage = queue_.front();
+            queue_.pop_front();
+            ++busy_;
+            lock.unlock();
+            long budget = std::numeric_limits<long>::max();
+            garbage.reclaim_(garbage.levels_, garbage.height_, budget);
+            lock.lock();
+            --busy_;
+            lock.unlock();
+            done_.notify_all();
+        }
+    }
+
+    void drainAll()
+    {
+        drain(std::numeric_limits<long>::max());
+        std::unique_lock<std::mutex> lock{mutex_};
+        done_.wait(lock, [this]{ return busy_ == 0; });
+    }
+
+    long drain(long budget)
+    {
+        const long initialBudget = budget;
+        while (budget > 0) {
+            std::unique_lock<std::mutex> lock{mutex_};
+            if (queue_.empty()) break;
+            Reclaimer::Garbage garbage = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            if (!garbage.reclaim_(garbage.levels_, garbage.height_, budget)) {
+                lock.lock();
+                queue_.push_front(garbage);
+            }
+        }
+        return initialBudget - budget;
+    }
+
+    std::mutex configMutex_; // serializes mode changes
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable done_;
+    std::deque<Reclaimer::Garbage> queue_;
+    std::thread thread_;
+    int busy_ { 0 };
+    bool stop_ { false };
+    std::atomic<ReclaimMode> mode_ { ReclaimMode::Inline };
+    std::atomic<long> threshold_ { 0 };
+};
+
+void shutdown();
+
+ReclaimerState &state()
+{
+    static ReclaimerState &instance = []() -> ReclaimerState & {
+        ReclaimerState *s = new ReclaimerState; // never destroyed, containers may be released during static destruction
+        std::atexit(shutdown);
+        return *s;
+    }();
+    return instance;
+}
+
+void shutdown()
+{
+    ReclaimerState &s = state();
+    std::lock_guard<std::mutex> config{s.configMutex_};
+    s.stopThread();
+    s.mode_ = ReclaimMode::Inline;
+    s.drainAll();
+}
+
+} // namespace
+
+void Reclaimer::setMode(ReclaimMode mode, long threshold)
+{
+    ReclaimerState &s = state();
+    std::lock_guard<std::mutex> config{s.configMutex_};
+    if (s.mode_ == ReclaimMode::Background && mode != ReclaimMode::Background) {
+        s.stopThread();
+    }
+    s.threshold_ = threshold;
+    if (s.mode_ != ReclaimMode::Background && mode == ReclaimMode::Background) {
+        s.startThread();
+    }
+    s.mode_ = mode;
+    if (mode == ReclaimMode::Inline) {
+        s.drainAll();
+    }
+}
+
+ReclaimMode Reclaimer::mode()
+{
+    return state().mode_;
+}
+
+long Reclaimer::tick(long budget)
+{
+    return state().drain(budget);
+}
+
+void Reclaimer::flush()
+{
+    state().drainAll();
+}
+
+long Reclaimer::pendingCount()
+{
+    ReclaimerState &s = state();
+    std::lock_guard<std::mutex> lock{s.mutex_};
+    return s.queue_.size() + s.busy_;
+}
+
+bool Reclaimer::accepts(long count)
+{
+    ReclaimerState &s = state();
+    return s.mode_ != ReclaimMode::Inline && count >= s.threshold_;
+}
+
+void Reclaimer::dispose(const Garbage &garbage)
+{
+    ReclaimerState &s = state();
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock{s.mutex_};
+        queued = s.mode_ != ReclaimMode::Inline; // setMode() might have switched to inline mode and drained the queue since accepts()
+        if (queued) s.queue_.push_back(garbage);
+    }
+    if (queued) {
+        s.wakeup_.notify_one();
+        return;
+    }
+    Garbage remaining = garbage;
+    long budget = std::numeric_limits<long>::max();
+    remaining.reclaim_(remaining.levels_, remaining.height_, budget);
+}
+
+} // namespace cc
@@ -0,0 +1,100 @@
+#include <cc/Symbol>
+#include <cc/blist/HashTable>
+#include <mutex>
+
+namespace cc {
+
+struct Symbol::Table
+{
+    /** Character range with precomputed hash value
+      */
+    struct Chars
+    {
+        const char *text;
+        long count;
+        std::uint64_t hash;
+
+        bool operator==(const Chars &other) const
+        {
+            return count == other.count && std::memcmp(text, other.text, count) == 0;
+        }
+    };
+
+    struct EntryKey
+    {
+        static Chars key(const Entry *entry)
+        {
+            return Chars{entry->text.chars(), entry->text.count(), entry->hash};
+        }
+    };
+
+    struct CharsHash
+    {
+        static std::uint64_t hash(const Chars &chars) { return chars.hash; }
+    };
+
+    static Table &instance()
+    {
+        static Table &table = *new Table; // never destroyed, symbols may outlive static destruction
+        return table;
+    }
+
+    const Entry *intern(const char *text, long count)
+    {
+        const Chars pattern { text, count, cc::hash(text, count) };
+        std::lock_guard<std::mutex> lock{mutex_};
+        const long id = entries_.count() + 1; // taken before produceUnique() claims the new slot
+        long slot = -1;
+        entries_.produceUnique(pattern, &slot, [&]{
+            return new Entry{String{text, count}, pattern.hash, id};
+        });
+        return entries_.at(slot);
+    }
+
+    const Entry *lookup(const char *text, long count)
+    {
+        const Chars pattern { text, count, cc::hash(text, count) };
+        std::lock_guard<std::mutex> lock{mutex_};
+        long slot = entries_.lookup(pattern);
+        return (slot >= 0) ? entries_.at(slot) : nullptr;
+    }
+
+    long count()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return entries_.count();
+    }
+
+    std::mutex mutex_;
+    blist::HashTable<const Entry *, CharsHash, EntryKey> entries_;
+};
+
+const Symbol::Entry *Symbol::intern(const char *text, long count)
+{
+    if (count == 0) return nullptr;
+    return Table::instance().intern(text, count);
+}
+
+const Symbol::Entry &Symbol::emptyEntry()
+{
+    static const Entry entry { String{}, cc::hash(nullptr, 0), 0 };
+    return entry;
+}
+
+bool Symbol::lookup(const String &text, Out<Symbol> symbol)
+{
+    if (text.count() == 0) {
+        symbol = Symbol{};
+        return true;
+    }
+    const Entry *entry = Table::instance().lookup(text.chars(), text.count());
+    if (entry) symbol().entry_ = entry;
+    return entry;
+}
+
+long Symbol::internedCount()
+{
+    return Table::instance().count();
+}
+
+} // namespace cc
@@ -0,0 +1,119 @@
+#include <cc/ThreadPool>
+
+namespace cc {
+
+namespace {
+
+struct CurrentWorker
+{
+    const ThreadPool *pool_ { nullptr };
+    unsigned index_ { 0 };
+};
+
+thread_local CurrentWorker currentWorker;
+
+} // namespace
+
+ThreadPool &ThreadPool::instance()
+{
+    static ThreadPool pool { std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0 };
+    return pool;
+}
+
+ThreadPool::ThreadPool(unsigned workerCount)
+{
+    // queue 0 is shared by all threads which are not workers of this pool
+    for (unsigned i = 0; i <= workerCount; ++i) {
+        queues_.emplace_back(new Queue);
+    }
+    for (unsigned i = 1; i <= workerCount; ++i) {
+        workers_.emplace_back([this, i]{ work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{idleMutex_};
+        stop_ = true;
+    }
+    idle_.notify_all();
+    for (std::thread &worker: workers_) worker.join();
+}
+
+unsigned ThreadPool::currentQueue() const
+{
+    return (currentWorker.pool_ == this) ? currentWorker.index_ : 0;
+}
+
+void ThreadPool::push(Task &&task)
+{
+    Queue &queue = *queues_[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock{queue.mutex_};
+        queue.tasks_.emplace_back(std::move(task));
+        ++queued_;
+    }
+    {
+        std::lock_guard<std::mutex> lock{idleMutex_};
+    }
+    idle_.notify_one();
+}
+
+bool ThreadPool::take(unsigned index, Task &task)
+{
+    if (queued_ == 0) return false;
+
+    const unsigned n = queues_.size();
+    for (unsigned k = 0; k < n; ++k) {
+        Queue &queue = *queues_[(index + k) % n];
+        std::lock_guard<std::mutex> lock{queue.mutex_};
+        if (queue.tasks_.empty()) continue;
+        if (k == 0) {
+            task = std::move(queue.tasks_.back());
+            queue.tasks_.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks_.front());
+            queue.tasks_.pop_front();
+        }
+        --queued_;
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::wait(Batch &batch)
+{
+    const unsigned index = currentQueue();
+    while (batch.pending_ > 0) {
+        Task task;
+        if (take(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{batch.mutex_};
+        batch.done_.wait(lock, [&]{ return batch.pending_ == 0 || queued_ > 0; });
+    }
+    std::lock_guard<std::mutex> lock{batch.mutex_}; // wait for the last task to leave the batch
+    if (batch.error_) std::rethrow_exception(batch.error_);
+}
+
+void ThreadPool::work(unsigned index)
+{
+    currentWorker = CurrentWorker{this, index};
+
+    while (true) {
+        Task task;
+        if (take(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{idleMutex_};
+        idle_.wait(lock, [this]{ return stop_ || queued_ > 0; });
+        if (stop_) break;
+    }
+}
+
+} // namespace cc
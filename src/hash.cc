@@ -0,0 +1,220 @@
+#include <cc/hash>
+#include <cc/Stream>
+#include <bit>
+#include <cstring>
+
+namespace cc {
+
+namespace {
+
+constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t P3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ULL;
+
+constexpr std::uint64_t Lsbs = 0x0101010101010101ULL;
+constexpr std::uint64_t Msbs = 0x8080808080808080ULL;
+
+/** Convert all upper-case ASCII characters in \a x to lower-case (8 characters at once)
+  */
+inline std::uint64_t lower64(std::uint64_t x)
+{
+    const std::uint64_t heptets = x & ~Msbs;
+    const std::uint64_t aboveA = heptets + (0x80 - 'A') * Lsbs;
+    const std::uint64_t aboveZ = heptets + (0x80 - 'Z' - 1) * Lsbs;
+    const std::uint64_t upper = aboveA & ~aboveZ & ~x & Msbs;
+    return x | (upper >> 2);
+}
+
+template<bool Casefree>
+inline std::uint64_t load64(const std::uint8_t *p)
+{
+    std::uint64_t x;
+    std::memcpy(&x, p, sizeof(x));
+    if constexpr (std::endian::native == std::endian::big) x = __builtin_bswap64(x);
+    if constexpr (Casefree) x = lower64(x);
+    return x;
+}
+
+template<bool Casefree>
+inline std::uint64_t load32(const std::uint8_t *p)
+{
+    std::uint32_t x;
+    std::memcpy(&x, p, sizeof(x));
+    if constexpr (std::endian::native == std::endian::big) x = __builtin_bswap32(x);
+    if constexpr (Casefree) return lower64(x);
+    return x;
+}
+
+template<bool Casefree>
+inline std::uint64_t load8(const std::uint8_t *p)
+{
+    std::uint8_t x = *p;
+    if constexpr (Casefree) x = toLower(x);
+    return x;
+}
+
+inline std::uint64_t round(std::uint64_t acc, std::uint64_t input)
+{
+    acc += input * P2;
+    acc = std::rotl(acc, 31);
+    return acc * P1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t h, std::uint64_t acc)
+{
+    h ^= round(0, acc);
+    return h * P1 + P4;
+}
+
+inline void initAccumulators(std::uint64_t *acc, std::uint64_t seed)
+{
+    acc[0] = seed + P1 + P2;
+    acc[1] = seed + P2;
+    acc[2] = seed;
+    acc[3] = seed - P1;
+}
+
+/** Feed all complete 32 byte stripes of [\a p, \a p + \a n) into the accumulators
+  * \return Number of bytes consumed
+  */
+template<bool Casefree>
+long consumeStripes(std::uint64_t *acc, const std::uint8_t *p, long n)
+{
+    std::uint64_t a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+    long i = 0;
+    for (; i + 32 <= n; i += 32) {
+        a0 = round(a0, load64<Casefree>(p + i));
+        a1 = round(a1, load64<Casefree>(p + i + 8));
+        a2 = round(a2, load64<Casefree>(p + i + 16));
+        a3 = round(a3, load64<Casefree>(p + i + 24));
+    }
+    acc[0] = a0; acc[1] = a1; acc[2] = a2; acc[3] = a3;
+    return i;
+}
+
+inline std::uint64_t mergeAccumulators(const std::uint64_t *acc)
+{
+    std::uint64_t h = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+    for (int k = 0; k < 4; ++k) h = mergeRound(h, acc[k]);
+    return h;
+}
+
+/** Mix the remaining \a n < 32 bytes at \a p into \a h and apply the final avalanche
+  */
+template<bool Casefree>
+std::uint64_t finalize(std::uint64_t h, const std::uint8_t *p, long n)
+{
+    for (; n >= 8; p += 8, n -= 8) {
+        h ^= round(0, load64<Casefree>(p));
+        h = std::rotl(h, 27) * P1 + P4;
+    }
+    if (n >= 4) {
+        h ^= load32<Casefree>(p) * P1;
+        h = std::rotl(h, 23) * P2 + P3;
+        p += 4;
+        n -= 4;
+    }
+    for (; n > 0; ++p, --n) {
+        h ^= load8<Casefree>(p) * P5;
+        h = std::rotl(h, 11) * P1;
+    }
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+template<bool Casefree>
+std::uint64_t hashBytes(const void *data, long size, std::uint64_t seed)
+{
+    const std::uint8_t *p = static_cast<const std::uint8_t *>(data);
+    std::uint64_t h = 0;
+    long i = 0;
+    if (size >= 32) {
+        std::uint64_t acc[4];
+        initAccumulators(acc, seed);
+        i = consumeStripes<Casefree>(acc, p, size);
+        h = mergeAccumulators(acc);
+    }
+    else {
+        h = seed + P5;
+    }
+    h += static_cast<std::uint64_t>(size);
+    return finalize<Casefree>(h, p + i, size - i);
+}
+
+} // namespace
+
+std::uint64_t hash(const void *data, long size, std::uint64_t seed)
+{
+    return hashBytes<false>(data, size, seed);
+}
+
+std::uint64_t hashCasefree(const void *data, long size, std::uint64_t seed)
+{
+    return hashBytes<true>(data, size, seed);
+}
+
+Hasher::Hasher(std::uint64_t seed, bool casefree):
+    seed_{seed},
+    casefree_{casefree}
+{
+    initAccumulators(acc_, seed);
+}
+
+Hasher &Hasher::feed(const void *data, long size)
+{
+    if (size <= 0) return *this;
+
+    const std::uint8_t *p = static_cast<const std::uint8_t *>(data);
+    total_ += size;
+
+    if (fill_ > 0) {
+        long n = 32 - fill_;
+        if (size < n) n = size;
+        std::memcpy(buffer_ + fill_, p, n);
+        fill_ += n;
+        p += n;
+        size -= n;
+        if (fill_ < 32) return *this;
+        if (casefree_) consumeStripes<true>(acc_, buffer_, 32);
+        else consumeStripes<false>(acc_, buffer_, 32);
+        fill_ = 0;
+    }
+
+    long i = casefree_ ? consumeStripes<true>(acc_, p, size) : consumeStripes<false>(acc_, p, size);
+    fill_ = size - i;
+    if (fill_ > 0) std::memcpy(buffer_, p + i, fill_);
+    return *this;
+}
+
+long long Hasher::feedFrom(const Stream &source, long long count)
+{
+    Stream stream{source};
+    Bytes buffer = Bytes::allocate((0 < count && count < 0x1000) ? count : 0x1000);
+    long long total = 0;
+
+    while (count != 0) {
+        long m = (count < 0 || buffer.count() < count) ? buffer.count() : count;
+        long n = stream.read(&buffer, m);
+        if (n == 0) break;
+        feed(buffer.items(), n);
+        total += n;
+        if (count > 0) count -= n;
+    }
+
+    return total;
+}
+
+std::uint64_t Hasher::finish() const
+{
+    std::uint64_t h = (total_ >= 32) ? mergeAccumulators(acc_) : seed_ + P5;
+    h += total_;
+    return casefree_ ? finalize<true>(h, buffer_, fill_) : finalize<false>(h, buffer_, fill_);
+}
+
+} // namespace cc
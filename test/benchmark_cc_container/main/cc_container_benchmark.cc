@@ -1,11 +1,17 @@
 #include <unistd.h>
 #include <inttypes.h>
+#include <cc/HashMap>
+#include <cc/HashSet>
 #include <cc/List>
 #include <cc/Map>
 #include <cc/MultiMap>
+#include <cc/PersistentMap>
 #include <cc/Set>
+#include <cc/Symbol>
 #include <cc/Array>
 #include <cc/Random>
+#include <cc/Reclaimer>
+#include <cc/ThreadPool>
 #include <cc/stdio>
 #include <deque>
 #include <list>
@@ -56,6 +62,30 @@ size_t getFreeHeap()
     return info.total_free_bytes;
 }
 
+/** Get the number of heap blocks currently allocated
+  */
+size_t getAllocatedBlocks()
+{
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+    return info.allocated_blocks;
+}
+
+/** Integer key whose tree nodes are allocated from the thread-local node pools
+  */
+struct PooledInt
+{
+    int value;
+
+    std::strong_ordering operator<=>(const PooledInt &other) const = default;
+};
+
+template<>
+struct cc::blist::StoragePolicy<PooledInt>: public cc::blist::DefaultStoragePolicy<PooledInt>
+{
+    using Allocator = cc::blist::PoolAllocator;
+};
+
 /** Generate a sequence of non-repeating pseudo-random numbers
   */
 std::vector<int> generateRandomInts(size_t n)
@@ -111,6 +141,46 @@ TEST_CASE("cc_blist_tree_overhead", "[cc]")
     }
 }
 
+/** Small record with optional (mostly empty) container fields
+  */
+struct SparseRecord
+{
+    int id;
+    cc::String name {};
+    cc::List<int> tags {};
+    cc::Map<int, int> attributes {};
+};
+
+TEST_CASE("cc_empty_container_overhead", "[cc]")
+{
+    const int n = 1000;
+
+    print("sizeof(SparseRecord) = %%\n", sizeof(SparseRecord));
+
+    std::vector<SparseRecord> records;
+    records.reserve(n);
+
+    size_t h = getFreeHeap();
+    size_t b = getAllocatedBlocks();
+    for (int i = 0; i < n; ++i) records.emplace_back(SparseRecord{ .id = i });
+    h -= getFreeHeap();
+    b = getAllocatedBlocks() - b;
+
+    print("%% empty records occupy %% bytes in %% heap blocks\n", n, h, b);
+    TEST_ASSERT(b == 0);
+
+    auto dt = benchmark(
+        [&]{
+            for (int i = 0; i < n; ++i) records.emplace_back(SparseRecord{ .id = i });
+        },
+        [&]{
+            records.clear();
+        }
+    );
+
+    print("constructing %% empty records took %%us\n", n, dt);
+}
+
 TEST_CASE("cc_list_append_runtime", "[cc]")
 {
     const int n = 10000;
@@ -315,82 +385,80 @@ TEST_CASE("std_deque_insert_randomized_runtime", "[std]")
     printArray("y", durations);
 }
 
-TEST_CASE("cc_list_iteration_runtime", "[cc]")
+TEST_CASE("cc_list_at_randomized_sparse_runtime", "[cc]")
 {
-    const int n = 10000;
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
 
-    cc::List<int> list;
-    for (int i = 0; i < n; ++i) {
-        list.append(i);
-    }
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
 
-    long sum = 0;
+    for (int n: counts)
+    {
+        cc::List<int> list;
+        for (int i = 0; i < n; ++i) {
+            list.insertAt(static_cast<unsigned>(v[i]) % (list.count() + 1), i);
+        }
+        TEST_ASSERT(!list.tree().isDense());
 
-    int64_t dt = benchmark(
-        [&]{
-            for (int i = 0; i < 10; ++i) {
-                for (const int &x: list) {
-                    sum += x;
+        long sum = 0;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    sum += list.at(static_cast<unsigned>(v[i]) % n);
                 }
             }
-        }
-    );
-
-    print("sum = %%\n", sum);
-    print("%%\tsteps in a cc::List<int> cost \t%%us\n", n, dt);
-}
+        );
 
-TEST_CASE("std_list_iteration_runtime", "[cc]")
-{
-    const int n = 10000;
+        TEST_ASSERT(sum > 0);
 
-    std::list<int> list;
-    for (int i = 0; i < n; ++i) {
-        list.push_back(i);
+        print("%%\trandom access into sparse cc::List<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
     }
 
-    long sum = 0;
-
-    int64_t dt = benchmark(
-        [&]{
-            for (int i = 0; i < 10; ++i) {
-                for (const int &x: list) {
-                    sum += x;
-                }
-            }
-        }
-    );
-
-    print("sum = %%\n", sum);
-    print("%%\tsteps in a std::list<int> cost \t%%us\n", n, dt);
+    printArray("x", counts);
+    printArray("y", durations);
 }
 
-TEST_CASE("std_deque_iteration_runtime", "[cc]")
+TEST_CASE("cc_list_at_randomized_compacted_runtime", "[cc]")
 {
-    const int n = 10000;
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
 
-    std::deque<int> list;
-    for (int i = 0; i < n; ++i) {
-        list.push_back(i);
-    }
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
 
-    long sum = 0;
+    for (int n: counts)
+    {
+        cc::List<int> list;
+        for (int i = 0; i < n; ++i) {
+            list.insertAt(static_cast<unsigned>(v[i]) % (list.count() + 1), i);
+        }
+        long saved = list.compact();
+        TEST_ASSERT(list.tree().isDense());
 
-    int64_t dt = benchmark(
-        [&]{
-            for (int i = 0; i < 10; ++i) {
-                for (const int &x: list) {
-                    sum += x;
+        long sum = 0;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    sum += list.at(static_cast<unsigned>(v[i]) % n);
                 }
             }
-        }
-    );
+        );
 
-    print("sum = %%\n", sum);
-    print("%%\tsteps in a std::deque<int> cost \t%%us\n", n, dt);
+        TEST_ASSERT(sum > 0);
+
+        print("%%\trandom access into compacted cc::List<int> cost \t%%us (%% bytes released)\n", n, dt, saved);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
 }
 
-TEST_CASE("cc_set_insert_randomized_runtime", "[cc]")
+TEST_CASE("cc_list_seek_sparse_runtime", "[cc]")
 {
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
@@ -400,20 +468,27 @@ TEST_CASE("cc_set_insert_randomized_runtime", "[cc]")
 
     for (int n: counts)
     {
-        cc::Set<int> set;
+        cc::List<int> list;
+        for (int i = 0; i < n; ++i) {
+            list.insertAt(static_cast<unsigned>(v[i]) % (list.count() + 1), i);
+        }
+        TEST_ASSERT(!list.tree().isDense());
+
+        long sum = 0;
 
         int64_t dt = benchmark(
             [&]{
+                cc::Locator pos = list.head();
                 for (int i = 0; i < n; ++i) {
-                    set.insert(v[i]);
+                    pos = pos + (static_cast<unsigned>(v[i]) % n - pos.index());
+                    sum += list.at(pos);
                 }
-            },
-            [&]{
-                set.deplete();
             }
         );
 
-        print("%%\trandom insertions into cc::Set<int> cost \t%%us\n", n, dt);
+        TEST_ASSERT(sum > 0);
+
+        print("%%	random locator jumps inside sparse cc::List<int> cost \t%%us\n", n, dt);
         durations.push_back(dt);
     }
 
@@ -421,32 +496,32 @@ TEST_CASE("cc_set_insert_randomized_runtime", "[cc]")
     printArray("y", durations);
 }
 
-TEST_CASE("cc_set_insert_ascending_runtime", "[cc]")
+void benchmarkListSort(unsigned threads)
 {
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
     durations.reserve(counts.size());
 
     std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
-    std::sort(v.begin(), v.end());
 
     for (int n: counts)
     {
-        cc::Set<int> set;
+        cc::List<int> list;
 
         int64_t dt = benchmark(
             [&]{
-                for (int i = 0; i < n; ++i) {
-                    set.insert(v[i]);
-                }
+                list.sort(threads);
             },
             [&]{
-                TEST_ASSERT(set.isDense());
-                set.deplete();
+                list.deplete();
+                for (int i = 0; i < n; ++i) list.append(v[i]);
             }
         );
 
-        print("%%\tascending insertions into cc::Set<int> cost \t%%us\n", n, dt);
+        TEST_ASSERT(list.count() == n);
+        TEST_ASSERT(list.first() <= list.last());
+
+        print("%%\tsorting a cc::List<int> (%% threads) cost \t%%us\n", n, threads, dt);
         durations.push_back(dt);
     }
 
@@ -454,37 +529,38 @@ TEST_CASE("cc_set_insert_ascending_runtime", "[cc]")
     printArray("y", durations);
 }
 
-TEST_CASE("std_set_insert_randomized_runtime", "[std]")
+TEST_CASE("cc_list_sort_runtime", "[cc]")
 {
-    using namespace cc;
+    benchmarkListSort(1);
+}
+
+TEST_CASE("cc_list_sort_parallel_runtime", "[cc]")
+{
+    benchmarkListSort(2);
+}
 
+TEST_CASE("std_vector_stable_sort_runtime", "[cc]")
+{
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
     durations.reserve(counts.size());
 
-    std::vector<int> v;
-    {
-        v.resize(counts[counts.size() - 1]);
-        Random random { 0 };
-        for (int &x: v) x = random();
-    }
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
 
     for (int n: counts)
     {
-        std::set<int> set;
+        std::vector<int> vector;
 
         int64_t dt = benchmark(
             [&]{
-                for (int i = 0; i < n; ++i) {
-                    set.insert(v[i]);
-                }
+                std::stable_sort(vector.begin(), vector.end());
             },
             [&]{
-                set.clear();
+                vector.assign(v.begin(), v.begin() + n);
             }
         );
 
-        print("%%\trandom insertions into std::set<int> took dt\t= %%us\n", n, dt);
+        print("%%\tsorting a std::vector<int> (std::stable_sort) cost \t%%us\n", n, dt);
         durations.push_back(dt);
     }
 
@@ -492,104 +568,530 @@ TEST_CASE("std_set_insert_randomized_runtime", "[std]")
     printArray("y", durations);
 }
 
-TEST_CASE("cc_set_insert_randomized_memory", "[cc]")
+TEST_CASE("cc_list_parallel_scaling_runtime", "[cc]")
 {
-    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
-    std::vector<size_t> heapSizes;
-    heapSizes.reserve(counts.size());
+    const int n = 20000;
 
-    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::vector<int> threadCounts { 1, 2, 3, 4 };
+    std::vector<int64_t> reduceDurations;
+    std::vector<int64_t> sortDurations;
 
-    size_t initialFreeHeap = getFreeHeap();
+    std::vector<int> v = generateRandomInts(n);
 
-    cc::Set<int> set;
+    cc::List<int> list;
+    for (int i = 0; i < n; ++i) list.append(v[i]);
 
-    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
-        set.insert(v[i]);
-        if (++i == counts[j]) {
-            ++j;
-            size_t u = initialFreeHeap - getFreeHeap();
-            heapSizes.push_back(u);
-            print("%%\trandom insertions into cc::Set<int> cost \t%% bytes\n", i, u);
-        }
-    }
+    for (int threads: threadCounts)
+    {
+        cc::ThreadPool pool { static_cast<unsigned>(threads - 1) };
 
-    printArray("x", counts);
-    printArray("y", heapSizes);
-}
+        long sum = 0;
 
-TEST_CASE("cc_set_insert_ascending_memory", "[cc]")
-{
-    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
-    std::vector<size_t> heapSizes;
-    heapSizes.reserve(counts.size());
+        int64_t dt = benchmark(
+            [&]{
+                sum = list.parallelReduce(
+                    0L,
+                    [](int x) { return static_cast<long>(x & 0xFF); },
+                    [](long a, long b) { return a + b; },
+                    pool
+                );
+            }
+        );
 
-    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
-    std::sort(v.begin(), v.end());
+        TEST_ASSERT(sum > 0);
 
-    size_t initialFreeHeap = getFreeHeap();
+        print("%%\tparallel reduction over a cc::List<int> (%% threads) cost \t%%us\n", n, threads, dt);
+        reduceDurations.push_back(dt);
 
-    cc::Set<int> set;
+        cc::List<int> sorted;
 
-    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
-        set.insert(v[i]);
-        if (++i == counts[j]) {
-            ++j;
-            size_t u = initialFreeHeap - getFreeHeap();
-            heapSizes.push_back(u);
-            print("%%\tascending insertions into cc::Set<int> cost \t%% bytes\n", i, u);
-        }
+        dt = benchmark(
+            [&]{
+                sorted.parallelSort(pool);
+            },
+            [&]{
+                sorted = list;
+                sorted.append(0); // detach
+            }
+        );
+
+        TEST_ASSERT(sorted.first() <= sorted.last());
+
+        print("%%\tparallel sorting of a cc::List<int> (%% threads) cost \t%%us\n", n, threads, dt);
+        sortDurations.push_back(dt);
     }
 
-    printArray("x", counts);
-    printArray("y", heapSizes);
+    printArray("x", threadCounts);
+    printArray("y_reduce", reduceDurations);
+    printArray("y_sort", sortDurations);
 }
 
-TEST_CASE("std_set_insert_randomized_memory", "[std]")
+TEST_CASE("cc_list_copy_on_write_runtime", "[cc]")
 {
-    using namespace cc;
-
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
-    std::vector<size_t> heapSizes;
-    heapSizes.reserve(counts.size());
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
 
-    std::vector<int> v;
+    for (int n: counts)
     {
-        v.resize(counts[counts.size() - 1]);
-        Random random { 0 };
-        for (int &x: v) x = random();
-    }
+        cc::List<int> list;
+        for (int i = 0; i < n; ++i) {
+            list.insertAt(i / 2, i);
+        }
 
-    size_t initialFreeHeap = getFreeHeap();
+        cc::List<int> copy;
 
-    std::set<int> set;
+        int64_t dt = benchmark(
+            [&]{
+                copy = list;
+                copy[0] = -1;
+            },
+            [&]{
+                copy = cc::List<int>{};
+            }
+        );
 
-    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
-        set.insert(v[i]);
-        if (++i == counts[j]) {
-            ++j;
-            size_t u = initialFreeHeap - getFreeHeap();
-            heapSizes.push_back(u);
-            print("%%\trandom insertions into std::set<int> cost \t%% bytes\n", i, u);
-        }
+        print("%%\tsized cc::List<int> copy on write costs \t%%us\n", n, dt);
+        durations.push_back(dt);
     }
 
     printArray("x", counts);
-    printArray("y", heapSizes);
+    printArray("y", durations);
 }
 
-TEST_CASE("std_unordered_set_insert_randomized_memory", "[std]")
+TEST_CASE("cc_map_insert_move_runtime", "[cc]")
 {
-    using namespace cc;
-
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
-    std::vector<size_t> heapSizes;
-    heapSizes.reserve(counts.size());
+    std::vector<int64_t> copyDurations;
+    std::vector<int64_t> moveDurations;
+    copyDurations.reserve(counts.size());
+    moveDurations.reserve(counts.size());
 
-    std::vector<int> v;
+    for (int n: counts)
     {
-        v.resize(counts[counts.size() - 1]);
-        Random random { 0 };
+        std::vector<std::vector<int>> values;
+        cc::Map<int, std::vector<int>> map;
+
+        auto init = [&]{
+            map = cc::Map<int, std::vector<int>>{};
+            values.clear();
+            for (int i = 0; i < n; ++i) values.emplace_back(16, i);
+        };
+
+        int64_t dtCopy = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) map.insert(i, values[i]);
+            },
+            init
+        );
+
+        int64_t dtMove = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) map.insert(int{i}, std::move(values[i]));
+            },
+            init
+        );
+
+        print("%%\tsized cc::Map<int, std::vector<int>> insert by copy \t%%us, by move \t%%us\n", n, dtCopy, dtMove);
+        copyDurations.push_back(dtCopy);
+        moveDurations.push_back(dtMove);
+    }
+
+    printArray("x", counts);
+    printArray("y_copy", copyDurations);
+    printArray("y_move", moveDurations);
+}
+
+TEST_CASE("cc_map_count_aggregation_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> findInsertDurations;
+    std::vector<int64_t> updateDurations;
+    findInsertDurations.reserve(counts.size());
+    updateDurations.reserve(counts.size());
+
+    for (int n: counts)
+    {
+        std::vector<int> keys;
+        keys.reserve(n);
+        cc::Random random { 0 };
+        for (int i = 0; i < n; ++i) keys.push_back(random.get(0, n / 4));
+
+        cc::Map<int, long> map;
+
+        int64_t dtFindInsert = benchmark(
+            [&]{
+                for (int key: keys) {
+                    cc::Locator pos;
+                    if (map.find(key, &pos)) ++map.at(pos).value();
+                    else map.insert(key, 1);
+                }
+            },
+            [&]{
+                map = cc::Map<int, long>{};
+            }
+        );
+
+        int64_t dtUpdate = benchmark(
+            [&]{
+                for (int key: keys) map.update(key, [](long &count){ ++count; });
+            },
+            [&]{
+                map = cc::Map<int, long>{};
+            }
+        );
+
+        print("%%\tkeys counted with cc::Map<int, long> find/insert \t%%us, update \t%%us\n", n, dtFindInsert, dtUpdate);
+        findInsertDurations.push_back(dtFindInsert);
+        updateDurations.push_back(dtUpdate);
+    }
+
+    printArray("x", counts);
+    printArray("y_find_insert", findInsertDurations);
+    printArray("y_update", updateDurations);
+}
+
+TEST_CASE("cc_list_iteration_runtime", "[cc]")
+{
+    const int n = 10000;
+
+    cc::List<int> list;
+    for (int i = 0; i < n; ++i) {
+        list.append(i);
+    }
+
+    long sum = 0;
+
+    int64_t dt = benchmark(
+        [&]{
+            for (int i = 0; i < 10; ++i) {
+                for (const int &x: list) {
+                    sum += x;
+                }
+            }
+        }
+    );
+
+    print("sum = %%\n", sum);
+    print("%%\tsteps in a cc::List<int> cost \t%%us\n", n, dt);
+}
+
+TEST_CASE("std_list_iteration_runtime", "[cc]")
+{
+    const int n = 10000;
+
+    std::list<int> list;
+    for (int i = 0; i < n; ++i) {
+        list.push_back(i);
+    }
+
+    long sum = 0;
+
+    int64_t dt = benchmark(
+        [&]{
+            for (int i = 0; i < 10; ++i) {
+                for (const int &x: list) {
+                    sum += x;
+                }
+            }
+        }
+    );
+
+    print("sum = %%\n", sum);
+    print("%%\tsteps in a std::list<int> cost \t%%us\n", n, dt);
+}
+
+TEST_CASE("std_deque_iteration_runtime", "[cc]")
+{
+    const int n = 10000;
+
+    std::deque<int> list;
+    for (int i = 0; i < n; ++i) {
+        list.push_back(i);
+    }
+
+    long sum = 0;
+
+    int64_t dt = benchmark(
+        [&]{
+            for (int i = 0; i < 10; ++i) {
+                for (const int &x: list) {
+                    sum += x;
+                }
+            }
+        }
+    );
+
+    print("sum = %%\n", sum);
+    print("%%\tsteps in a std::deque<int> cost \t%%us\n", n, dt);
+}
+
+TEST_CASE("cc_set_insert_randomized_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
+    for (int n: counts)
+    {
+        cc::Set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    set.insert(v[i]);
+                }
+            },
+            [&]{
+                set.deplete();
+            }
+        );
+
+        print("%%\trandom insertions into cc::Set<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_insert_ascending_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::sort(v.begin(), v.end());
+
+    for (int n: counts)
+    {
+        cc::Set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    set.insert(v[i]);
+                }
+            },
+            [&]{
+                TEST_ASSERT(set.isDense());
+                set.deplete();
+            }
+        );
+
+        print("%%\tascending insertions into cc::Set<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_insert_ascending_hinted_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::sort(v.begin(), v.end());
+
+    for (int n: counts)
+    {
+        cc::Set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                cc::Locator pos;
+                for (int i = 0; i < n; ++i) {
+                    set.insert(pos, v[i], &pos);
+                }
+            },
+            [&]{
+                TEST_ASSERT(set.isDense());
+                set.deplete();
+            }
+        );
+
+        print("%%\thinted ascending insertions into cc::Set<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_bulk_load_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::sort(v.begin(), v.end());
+
+    for (int n: counts)
+    {
+        cc::Set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                set = cc::Set<int>(v.begin(), v.begin() + n);
+            },
+            [&]{
+                set.deplete();
+            }
+        );
+
+        TEST_ASSERT(set.isDense());
+
+        print("%%\tsorted items bulk loaded into cc::Set<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("std_set_insert_randomized_runtime", "[std]")
+{
+    using namespace cc;
+
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v;
+    {
+        v.resize(counts[counts.size() - 1]);
+        Random random { 0 };
+        for (int &x: v) x = random();
+    }
+
+    for (int n: counts)
+    {
+        std::set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    set.insert(v[i]);
+                }
+            },
+            [&]{
+                set.clear();
+            }
+        );
+
+        print("%%\trandom insertions into std::set<int> took dt\t= %%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_insert_randomized_memory", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<size_t> heapSizes;
+    heapSizes.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
+    size_t initialFreeHeap = getFreeHeap();
+
+    cc::Set<int> set;
+
+    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
+        set.insert(v[i]);
+        if (++i == counts[j]) {
+            ++j;
+            size_t u = initialFreeHeap - getFreeHeap();
+            heapSizes.push_back(u);
+            print("%%\trandom insertions into cc::Set<int> cost \t%% bytes\n", i, u);
+        }
+    }
+
+    printArray("x", counts);
+    printArray("y", heapSizes);
+}
+
+TEST_CASE("cc_set_insert_ascending_memory", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<size_t> heapSizes;
+    heapSizes.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::sort(v.begin(), v.end());
+
+    size_t initialFreeHeap = getFreeHeap();
+
+    cc::Set<int> set;
+
+    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
+        set.insert(v[i]);
+        if (++i == counts[j]) {
+            ++j;
+            size_t u = initialFreeHeap - getFreeHeap();
+            heapSizes.push_back(u);
+            print("%%\tascending insertions into cc::Set<int> cost \t%% bytes\n", i, u);
+        }
+    }
+
+    printArray("x", counts);
+    printArray("y", heapSizes);
+}
+
+TEST_CASE("std_set_insert_randomized_memory", "[std]")
+{
+    using namespace cc;
+
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<size_t> heapSizes;
+    heapSizes.reserve(counts.size());
+
+    std::vector<int> v;
+    {
+        v.resize(counts[counts.size() - 1]);
+        Random random { 0 };
+        for (int &x: v) x = random();
+    }
+
+    size_t initialFreeHeap = getFreeHeap();
+
+    std::set<int> set;
+
+    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
+        set.insert(v[i]);
+        if (++i == counts[j]) {
+            ++j;
+            size_t u = initialFreeHeap - getFreeHeap();
+            heapSizes.push_back(u);
+            print("%%\trandom insertions into std::set<int> cost \t%% bytes\n", i, u);
+        }
+    }
+
+    printArray("x", counts);
+    printArray("y", heapSizes);
+}
+
+TEST_CASE("std_unordered_set_insert_randomized_memory", "[std]")
+{
+    using namespace cc;
+
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<size_t> heapSizes;
+    heapSizes.reserve(counts.size());
+
+    std::vector<int> v;
+    {
+        v.resize(counts[counts.size() - 1]);
+        Random random { 0 };
         for (int &x: v) x = random();
     }
 
@@ -608,20 +1110,384 @@ TEST_CASE("std_unordered_set_insert_randomized_memory", "[std]")
     }
 
     printArray("x", counts);
-    printArray("y", heapSizes);
+    printArray("y", heapSizes);
+}
+
+TEST_CASE("cc_hash_set_insert_randomized_memory", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<size_t> heapSizes;
+    heapSizes.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
+    size_t initialFreeHeap = getFreeHeap();
+
+    cc::HashSet<int> set;
+
+    for (int i = 0, j = 0; i < counts[counts.size() - 1];) {
+        set.insert(v[i]);
+        if (++i == counts[j]) {
+            ++j;
+            size_t u = initialFreeHeap - getFreeHeap();
+            heapSizes.push_back(u);
+            print("%%\trandom insertions into cc::HashSet<int> cost \t%% bytes\n", i, u);
+        }
+    }
+
+    printArray("x", counts);
+    printArray("y", heapSizes);
+}
+
+/** Measure random insertions, lookups and removals on a set of type \a SetType
+  */
+template<class SetType>
+void benchmarkSetInsertLookupRemove(const char *typeName)
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> insertDurations;
+    std::vector<int64_t> lookupDurations;
+    std::vector<int64_t> removeDurations;
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
+    auto remove = [](SetType &set, int x) {
+        if constexpr (requires { set.remove(x); }) set.remove(x);
+        else set.erase(x);
+    };
+
+    for (int n: counts)
+    {
+        SetType set;
+
+        int64_t dtInsert = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) set.insert(v[i]);
+            },
+            [&]{
+                set = SetType{};
+            }
+        );
+
+        int64_t dtLookup = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    if (!set.contains(v[i])) TEST_ASSERT(false);
+                }
+            }
+        );
+
+        int64_t dtRemove = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) remove(set, v[i]);
+            },
+            [&]{
+                for (int i = 0; i < n; ++i) set.insert(v[i]);
+            }
+        );
+
+        print("%%\trandom insertions/lookups/removals on %% cost \t%%us\t%%us\t%%us\n", n, typeName, dtInsert, dtLookup, dtRemove);
+        insertDurations.push_back(dtInsert);
+        lookupDurations.push_back(dtLookup);
+        removeDurations.push_back(dtRemove);
+    }
+
+    printArray("x", counts);
+    printArray("y_insert", insertDurations);
+    printArray("y_lookup", lookupDurations);
+    printArray("y_remove", removeDurations);
+}
+
+TEST_CASE("cc_hash_set_insert_lookup_remove_runtime", "[cc]")
+{
+    benchmarkSetInsertLookupRemove<cc::HashSet<int>>("cc::HashSet<int>");
+}
+
+TEST_CASE("cc_set_insert_lookup_remove_runtime", "[cc]")
+{
+    benchmarkSetInsertLookupRemove<cc::Set<int>>("cc::Set<int>");
+}
+
+TEST_CASE("std_unordered_set_insert_lookup_remove_runtime", "[std]")
+{
+    benchmarkSetInsertLookupRemove<std::unordered_set<int>>("std::unordered_set<int>");
+}
+
+/** Measure random lookups of string keys in a map of type \a MapType
+  */
+template<class MapType>
+void benchmarkStringKeyLookup(const char *typeName)
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::vector<cc::String> keys;
+    keys.reserve(v.size());
+    for (int x: v) keys.emplace_back(cc::str(x));
+
+    for (int n: counts)
+    {
+        MapType map;
+        for (int i = 0; i < n; ++i) map.insert(keys[i], i);
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    if (!map.contains(keys[i])) TEST_ASSERT(false);
+                }
+            }
+        );
+
+        print("%%\trandom string key lookups into %% cost \t%%us\n", n, typeName, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_hash_map_string_lookup_runtime", "[cc]")
+{
+    benchmarkStringKeyLookup<cc::HashMap<cc::String, int>>("cc::HashMap<String, int>");
+}
+
+TEST_CASE("cc_map_string_lookup_runtime", "[cc]")
+{
+    benchmarkStringKeyLookup<cc::Map<cc::String, int>>("cc::Map<String, int>");
+}
+
+/** Byte at a time FNV-1a hash (baseline)
+  */
+uint64_t hashFnv1a(const void *data, long size)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (long i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+/** Measure the throughput of hash function \a f for key sizes from 8 bytes up to 1 MB
+  * \note Keys larger than 64 KB are fed chunk by chunk via \a feed
+  */
+template<class F, class G>
+void benchmarkHashThroughput(const char *typeName, F f, G feed)
+{
+    const long volume = 1 << 20;
+    const long chunk = 1 << 16;
+
+    std::vector<int> counts { 8, 16, 32, 64, 128, 256, 1024, 4096, 16384, 65536, 262144, 1048576 };
+    std::vector<int64_t> rates;
+    rates.reserve(counts.size());
+
+    cc::Bytes buffer = cc::Bytes::allocate(chunk);
+    cc::Random random{0};
+    for (long i = 0; i < buffer.count(); ++i) buffer[i] = random.get('A', 'z');
+
+    for (int n: counts)
+    {
+        volatile uint64_t sink = 0;
+
+        int64_t dt = benchmark(
+            [&]{
+                if (n <= chunk) {
+                    for (long i = 0; i < volume / n; ++i) sink = sink + f(buffer.items() + (i % (chunk / n)) * n, n);
+                }
+                else {
+                    for (long i = 0; i < volume / n; ++i) sink = sink + feed(buffer.items(), chunk, n / chunk);
+                }
+            }
+        );
+
+        int64_t rate = (dt > 0) ? volume / dt : 0; // bytes per us = MB/s
+
+        print("%%\t%%-byte keys hashed by %% at \t%%MB/s\n", volume, n, typeName, rate);
+        rates.push_back(rate);
+    }
+
+    printArray("x", counts);
+    printArray("y", rates);
+}
+
+TEST_CASE("cc_hash_throughput_runtime", "[cc]")
+{
+    benchmarkHashThroughput("cc::hash()",
+        [](const uint8_t *data, long size) { return cc::hash(data, size); },
+        [](const uint8_t *data, long size, long repeat) {
+            cc::Hasher hasher;
+            for (long i = 0; i < repeat; ++i) hasher.feed(data, size);
+            return hasher.finish();
+        }
+    );
+}
+
+TEST_CASE("cc_hash_casefree_throughput_runtime", "[cc]")
+{
+    benchmarkHashThroughput("cc::hashCasefree()",
+        [](const uint8_t *data, long size) { return cc::hashCasefree(data, size); },
+        [](const uint8_t *data, long size, long repeat) {
+            cc::Hasher hasher{0, true};
+            for (long i = 0; i < repeat; ++i) hasher.feed(data, size);
+            return hasher.finish();
+        }
+    );
+}
+
+TEST_CASE("fnv1a_hash_throughput_runtime", "[cc]")
+{
+    benchmarkHashThroughput("FNV-1a",
+        [](const uint8_t *data, long size) { return hashFnv1a(data, size); },
+        [](const uint8_t *data, long size, long repeat) {
+            uint64_t h = 0;
+            for (long i = 0; i < repeat; ++i) h ^= hashFnv1a(data, size);
+            return h;
+        }
+    );
+}
+
+/** Measure random lookups of field name keys (of type \a Key) in a map of type \a MapType
+  */
+template<class MapType, class Key>
+void benchmarkFieldNameLookup(const char *typeName)
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::vector<Key> keys;
+    keys.reserve(v.size());
+    for (int x: v) keys.emplace_back(cc::str("x-field-name-") + cc::str(x));
+
+    for (int n: counts)
+    {
+        MapType map;
+        for (int i = 0; i < n; ++i) map.insert(keys[i], i);
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    if (!map.contains(keys[i])) TEST_ASSERT(false);
+                }
+            }
+        );
+
+        print("%%\trandom field name lookups into %% cost \t%%us\n", n, typeName, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_map_field_name_lookup_runtime", "[cc]")
+{
+    benchmarkFieldNameLookup<cc::Map<cc::String, int>, cc::String>("cc::Map<String, int>");
+}
+
+TEST_CASE("cc_map_symbol_lookup_runtime", "[cc]")
+{
+    benchmarkFieldNameLookup<cc::Map<cc::Symbol, int, cc::InternOrder>, cc::Symbol>("cc::Map<Symbol, int, InternOrder>");
+}
+
+TEST_CASE("cc_hash_map_symbol_lookup_runtime", "[cc]")
+{
+    benchmarkFieldNameLookup<cc::HashMap<cc::Symbol, int>, cc::Symbol>("cc::HashMap<Symbol, int>");
+}
+
+TEST_CASE("cc_set_lookup_randomized_sparse_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
+    for (int n: counts)
+    {
+        cc::Set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    if (!set.contains(v[i])) {
+                        TEST_ASSERT(false);
+                    }
+                }
+            },
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    set.insert(v[i]);
+                }
+            }
+        );
+
+        print("%%\trandom lookups into sparse cc::Set<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_lookup_randomized_dense_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::sort(v.begin(), v.end());
+
+    for (int n: counts)
+    {
+        cc::Set<int> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    if (!set.contains(v[i])) {
+                        TEST_ASSERT(false);
+                    }
+                }
+            },
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    set.insert(v[i]);
+                }
+            }
+        );
+
+        print("%%\trandom lookups into dense cc::Set<int> cost \t%%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
 }
 
-TEST_CASE("cc_set_lookup_randomized_sparse_runtime", "[cc]")
+TEST_CASE("std_set_lookup_randomized_runtime", "[std]")
 {
+    using namespace cc;
+
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
     durations.reserve(counts.size());
 
-    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+    std::vector<int> v;
+    {
+        v.resize(counts[counts.size() - 1]);
+        Random random { 0 };
+        for (int &x: v) x = random();
+    }
 
     for (int n: counts)
     {
-        cc::Set<int> set;
+        std::set<int> set;
 
         int64_t dt = benchmark(
             [&]{
@@ -638,7 +1504,7 @@ TEST_CASE("cc_set_lookup_randomized_sparse_runtime", "[cc]")
             }
         );
 
-        print("%%\trandom lookups into sparse cc::Set<int> cost \t%%us\n", n, dt);
+        print("%%\trandom lookups into dense std::set<int> cost \t%%us\n", n, dt);
         durations.push_back(dt);
     }
 
@@ -646,35 +1512,62 @@ TEST_CASE("cc_set_lookup_randomized_sparse_runtime", "[cc]")
     printArray("y", durations);
 }
 
-TEST_CASE("cc_set_lookup_randomized_dense_runtime", "[cc]")
+TEST_CASE("cc_set_unite_runtime", "[cc]")
 {
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
     durations.reserve(counts.size());
 
-    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
-    std::sort(v.begin(), v.end());
+    std::vector<int> v = generateRandomInts(2 * counts[counts.size() - 1]);
 
     for (int n: counts)
     {
-        cc::Set<int> set;
+        cc::Set<int> a, b, c;
+        for (int i = 0; i < n; ++i) {
+            a.insert(v[i]);
+            b.insert(v[n + i]);
+        }
 
         int64_t dt = benchmark(
             [&]{
-                for (int i = 0; i < n; ++i) {
-                    if (!set.contains(v[i])) {
-                        TEST_ASSERT(false);
-                    }
-                }
+                c = a.united(b);
+            }
+        );
+
+        print("%%\tsized union of two cc::Set<int> took dt\t= %%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_unite_by_insertion_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(2 * counts[counts.size() - 1]);
+
+    for (int n: counts)
+    {
+        cc::Set<int> a, b, c;
+        for (int i = 0; i < n; ++i) {
+            a.insert(v[i]);
+            b.insert(v[n + i]);
+        }
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int x: b) c.insert(x);
             },
             [&]{
-                for (int i = 0; i < n; ++i) {
-                    set.insert(v[i]);
-                }
+                c = cc::Set<int>{a.begin(), a.end()};
             }
         );
 
-        print("%%\trandom lookups into dense cc::Set<int> cost \t%%us\n", n, dt);
+        print("%%\tsized union of two cc::Set<int> by insertion took dt\t= %%us\n", n, dt);
         durations.push_back(dt);
     }
 
@@ -682,32 +1575,85 @@ TEST_CASE("cc_set_lookup_randomized_dense_runtime", "[cc]")
     printArray("y", durations);
 }
 
-TEST_CASE("std_set_lookup_randomized_runtime", "[std]")
+TEST_CASE("cc_set_unite_sparse_runtime", "[cc]")
 {
-    using namespace cc;
+    std::vector<int> counts { 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(2 * counts[counts.size() - 1]);
+
+    for (int n: counts)
+    {
+        cc::Set<int> a, b, c;
+        for (int i = 0; i < n; ++i) a.insert(v[i]);
+        for (int i = 0; i < n / 64; ++i) b.insert(v[n + i]);
 
+        int64_t dt = benchmark(
+            [&]{
+                c.unite(b);
+            },
+            [&]{
+                c = cc::Set<int>{a.begin(), a.end()};
+            }
+        );
+
+        print("%%	union of a cc::Set<int> with a 64 times smaller one took dt\t= %%us\n", n, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("std_set_union_runtime", "[std]")
+{
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
     durations.reserve(counts.size());
 
-    std::vector<int> v;
+    std::vector<int> v = generateRandomInts(2 * counts[counts.size() - 1]);
+
+    for (int n: counts)
     {
-        v.resize(counts[counts.size() - 1]);
-        Random random { 0 };
-        for (int &x: v) x = random();
+        std::set<int> a, b, c;
+        for (int i = 0; i < n; ++i) {
+            a.insert(v[i]);
+            b.insert(v[n + i]);
+        }
+
+        int64_t dt = benchmark(
+            [&]{
+                std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::inserter(c, c.end()));
+            },
+            [&]{
+                c.clear();
+            }
+        );
+
+        print("%%\tsized std::set_union() of two std::set<int> took dt\t= %%us\n", n, dt);
+        durations.push_back(dt);
     }
 
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_destruction_sparse_runtime", "[cc]")
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
     for (int n: counts)
     {
-        std::set<int> set;
+        cc::Set<int> set;
 
         int64_t dt = benchmark(
             [&]{
-                for (int i = 0; i < n; ++i) {
-                    if (!set.contains(v[i])) {
-                        TEST_ASSERT(false);
-                    }
-                }
+                set.deplete();
             },
             [&]{
                 for (int i = 0; i < n; ++i) {
@@ -716,7 +1662,7 @@ TEST_CASE("std_set_lookup_randomized_runtime", "[std]")
             }
         );
 
-        print("%%\trandom lookups into dense std::set<int> cost \t%%us\n", n, dt);
+        print("%%\tsized sparse cc::Set<int> destruction costs \t%%us\n", n, dt);
         durations.push_back(dt);
     }
 
@@ -724,7 +1670,7 @@ TEST_CASE("std_set_lookup_randomized_runtime", "[std]")
     printArray("y", durations);
 }
 
-TEST_CASE("cc_set_destruction_sparse_runtime", "[cc]")
+TEST_CASE("cc_set_destruction_deferred_runtime", "[cc]")
 {
     std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
     std::vector<int64_t> durations;
@@ -732,6 +1678,8 @@ TEST_CASE("cc_set_destruction_sparse_runtime", "[cc]")
 
     std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
 
+    cc::Reclaimer::setMode(cc::ReclaimMode::Incremental, 0);
+
     for (int n: counts)
     {
         cc::Set<int> set;
@@ -741,16 +1689,19 @@ TEST_CASE("cc_set_destruction_sparse_runtime", "[cc]")
                 set.deplete();
             },
             [&]{
+                cc::Reclaimer::flush();
                 for (int i = 0; i < n; ++i) {
                     set.insert(v[i]);
                 }
             }
         );
 
-        print("%%\tsized sparse cc::Set<int> destruction costs \t%%us\n", n, dt);
+        print("%%\tsized sparse cc::Set<int> deferred destruction costs \t%%us\n", n, dt);
         durations.push_back(dt);
     }
 
+    cc::Reclaimer::setMode(cc::ReclaimMode::Inline);
+
     printArray("x", counts);
     printArray("y", durations);
 }
@@ -832,6 +1783,237 @@ TEST_CASE("std_set_destruction_runtime", "[std]")
     printArray("y", durations);
 }
 
+/** Measure taking a snapshot of a map followed by a single modification
+  * \tparam MapType Map type (cc::Map<int, int> or cc::PersistentMap<int, int>)
+  */
+template<class MapType>
+void benchmarkMapSnapshotEdit(const char *typeName)
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(counts[counts.size() - 1]);
+
+    const int m = 100;
+
+    for (int n: counts)
+    {
+        MapType map;
+        for (int i = 0; i < n; ++i) map.establish(v[i], i);
+
+        std::vector<MapType> snapshots;
+        snapshots.reserve(m);
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < m; ++i) {
+                    snapshots.emplace_back(map);
+                    map.establish(v[(i * 7919) % n], -i);
+                }
+            },
+            [&]{
+                snapshots.clear();
+            }
+        );
+
+        print("%%\tsized %%: %% snapshot/modify cycles cost \t%%us\n", n, typeName, m, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_map_snapshot_edit_runtime", "[cc]")
+{
+    benchmarkMapSnapshotEdit<cc::Map<int, int>>("cc::Map<int, int>");
+}
+
+TEST_CASE("cc_persistent_map_snapshot_edit_runtime", "[cc]")
+{
+    benchmarkMapSnapshotEdit<cc::PersistentMap<int, int>>("cc::PersistentMap<int, int>");
+}
+
+/** Measure random remove/insert cycles on sets of different sizes
+  * \tparam Key Key type (int or PooledInt)
+  */
+template<class Key>
+void benchmarkSetChurn(const char *typeName)
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<int64_t> durations;
+    durations.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(2 * counts[counts.size() - 1]);
+
+    for (int n: counts)
+    {
+        cc::Set<Key> set;
+
+        int64_t dt = benchmark(
+            [&]{
+                for (int i = 0; i < n; ++i) {
+                    set.remove(Key{v[i]});
+                    set.insert(Key{v[n + i]});
+                }
+            },
+            [&]{
+                set.deplete();
+                for (int i = 0; i < n; ++i) {
+                    set.insert(Key{v[i]});
+                }
+            }
+        );
+
+        print("%%\trandom remove/insert cycles on %% cost \t%%us\n", n, typeName, dt);
+        durations.push_back(dt);
+    }
+
+    printArray("x", counts);
+    printArray("y", durations);
+}
+
+TEST_CASE("cc_set_churn_runtime", "[cc]")
+{
+    benchmarkSetChurn<int>("cc::Set<int>");
+}
+
+TEST_CASE("cc_set_churn_pooled_runtime", "[cc]")
+{
+    benchmarkSetChurn<PooledInt>("cc::Set<PooledInt>");
+}
+
+/** Count the heap blocks allocated after random remove/insert cycles on sets of different sizes
+  * \tparam Key Key type (int or PooledInt)
+  */
+template<class Key>
+void countSetChurnBlocks(const char *typeName)
+{
+    std::vector<int> counts { 100, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000, 10000 };
+    std::vector<size_t> blockCounts;
+    blockCounts.reserve(counts.size());
+
+    std::vector<int> v = generateRandomInts(2 * counts[counts.size() - 1]);
+
+    for (int n: counts)
+    {
+        size_t initialBlocks = getAllocatedBlocks();
+        {
+            cc::Set<Key> set;
+            for (int i = 0; i < n; ++i) {
+                set.insert(Key{v[i]});
+            }
+            for (int i = 0; i < n; ++i) {
+                set.remove(Key{v[i]});
+                set.insert(Key{v[n + i]});
+            }
+
+            size_t b = getAllocatedBlocks() - initialBlocks;
+            print("%%\trandom remove/insert cycles on %% leave \t%% heap blocks\n", n, typeName, b);
+            blockCounts.push_back(b);
+        }
+    }
+
+    printArray("x", counts);
+    printArray("y", blockCounts);
+}
+
+TEST_CASE("cc_set_churn_heap_blocks", "[cc]")
+{
+    countSetChurnBlocks<int>("cc::Set<int>");
+}
+
+TEST_CASE("cc_set_churn_pooled_heap_blocks", "[cc]")
+{
+    countSetChurnBlocks<PooledInt>("cc::Set<PooledInt>");
+}
+
+/** Record of \a Size bytes ordered by its key
+  */
+template<int Size>
+struct Record
+{
+    int key;
+    char payload[Size - sizeof(int)] {};
+
+    std::strong_ordering operator<=>(const Record &other) const { return key <=> other.key; }
+};
+
+int keyOf(int item) { return item; }
+
+template<int Size>
+int keyOf(const Record<Size> &item) { return item.key; }
+
+/** Measure sorted insertion, lookup and iteration of \a Item for granularity \a G
+  */
+template<class Item, unsigned G>
+void benchmarkGranularity()
+{
+    const int n = 10000;
+
+    std::vector<int> v = generateRandomInts(n);
+
+    cc::blist::Vector<Item, G> vector;
+
+    int64_t dtInsert = benchmark(
+        [&]{
+            for (int i = 0; i < n; ++i) {
+                vector.insertUnique(Item{v[i]});
+            }
+        },
+        [&]{
+            vector.deplete();
+        }
+    );
+
+    long found = 0;
+
+    int64_t dtLookup = benchmark(
+        [&]{
+            for (int i = 0; i < n; ++i) {
+                found += vector.find(Item{v[i]});
+            }
+        }
+    );
+
+    long sum = 0;
+
+    int64_t dtIteration = benchmark(
+        [&]{
+            for (int i = 0; i < 10; ++i) {
+                for (auto pos = vector.head(); pos; ++pos) {
+                    sum += keyOf(vector.at(pos));
+                }
+            }
+        }
+    );
+
+    TEST_ASSERT(found == 3 * n);
+
+    print("%%\t%%\t%%us\t%%us\t%%us\n", sizeof(Item), G, dtInsert, dtLookup, dtIteration);
+}
+
+TEST_CASE("cc_blist_granularity_sweep_runtime", "[cc]")
+{
+    print("sizeof(Item)\tG\tinsert\tlookup\titeration (%% items)\n", 10000);
+
+    benchmarkGranularity<int, 8>();
+    benchmarkGranularity<int, 16>();
+    benchmarkGranularity<int, 32>();
+    benchmarkGranularity<int, 64>();
+
+    benchmarkGranularity<Record<16>, 8>();
+    benchmarkGranularity<Record<16>, 16>();
+    benchmarkGranularity<Record<16>, 32>();
+    benchmarkGranularity<Record<16>, 64>();
+
+    benchmarkGranularity<Record<64>, 8>();
+    benchmarkGranularity<Record<64>, 16>();
+    benchmarkGranularity<Record<64>, 32>();
+    benchmarkGranularity<Record<64>, 64>();
+}
+
 extern "C" void app_main(void)
 {
     print("ESP-IDF: %%\n", esp_get_idf_version());
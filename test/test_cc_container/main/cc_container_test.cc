@@ -1,12 +1,24 @@
+#include <cc/HashMap>
+#include <cc/HashSet>
 #include <cc/List>
 #include <cc/Map>
 #include <cc/MultiMap>
+#include <cc/MultiSet>
+#include <cc/PersistentMap>
+#include <cc/Queue>
 #include <cc/Set>
+#include <cc/Symbol>
 #include <cc/Array>
+#include <cc/Casefree>
 #include <cc/Function>
+#include <cc/NullStream>
 #include <cc/Random>
+#include <cc/Reclaimer>
+#include <cc/ThreadPool>
 #include <cc/stdio>
 #include <sdkconfig.h>
+#include <memory>
+#include <thread>
 
 #include <unity.h>
 #include <unity_test_utils.h>
@@ -79,6 +91,154 @@ TEST_CASE("cc_list_sort", "[cc]")
     }
 }
 
+struct KeyOrder
+{
+    static std::strong_ordering compare(const std::pair<int, int> &a, const std::pair<int, int> &b)
+    {
+        return a.first <=> b.first;
+    }
+};
+
+TEST_CASE("cc_list_sort_stable", "[cc]")
+{
+    for (int n: { 0, 1, 2, 100, 5000, 20000 }) {
+        for (unsigned threads: { 1u, 4u }) {
+            List<std::pair<int, int>> a;
+            Random random{static_cast<uint32_t>(n)};
+            for (int i = 0; i < n; ++i) a.insertAt(random.get(0, a.count() + 1), std::pair<int, int>{random.get(0, 100), 0});
+            for (int i = 0; i < n; ++i) a[i].second = i;
+
+            a.sort<KeyOrder>(threads);
+            TEST_ASSERT(a.count() == n);
+            for (int i = 1; i < n; ++i) {
+                TEST_ASSERT(a.at(i - 1).first < a.at(i).first || (a.at(i - 1).first == a.at(i).first && a.at(i - 1).second < a.at(i).second));
+            }
+            TEST_ASSERT(n == 0 || a.tree().isDense());
+
+            a.sortUnique<KeyOrder>();
+            TEST_ASSERT(n < 5000 || a.count() == 100);
+            for (int i = 1; i < a.count(); ++i) TEST_ASSERT(a.at(i - 1).first < a.at(i).first);
+        }
+    }
+
+    List<int> b { 3, 1, 2, 3, 1 };
+    TEST_ASSERT(b.sortedUnique() == (List<int>{ 1, 2, 3 }));
+    b.sort<ReverseOrder>();
+    TEST_ASSERT(b == (List<int>{ 3, 3, 2, 1, 1 }));
+}
+
+TEST_CASE("cc_thread_pool", "[cc]")
+{
+    ThreadPool pool { 3 };
+    TEST_ASSERT(pool.concurrency() == 4);
+
+    std::atomic<long> sum { 0 };
+    pool.forEachIndex(1000, [&](long i) {
+        pool.invoke(
+            [&]{ sum += i; },
+            [&]{ sum += i; }
+        );
+    });
+    TEST_ASSERT(sum == 999 * 1000);
+
+    bool caught = false;
+    try {
+        pool.forEachIndex(10, [](long i) { if (i == 7) throw i; });
+    }
+    catch (long i) {
+        caught = (i == 7);
+    }
+    TEST_ASSERT(caught);
+
+    std::atomic<bool> slowDone { false };
+    pool.invoke(
+        []{},
+        [&]{
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+            slowDone = true;
+        }
+    );
+    TEST_ASSERT(slowDone);
+
+    const int n = 20000;
+    List<int> list;
+    Random random{0};
+    for (int i = 0; i < n; ++i) list.insertAt(random.get(0, list.count() + 1), i);
+
+    list.parallelForEach([](int &x) { x *= 2; }, pool);
+    long total = list.parallelReduce(0L, [](int x) { return long(x); }, [](long a, long b) { return a + b; }, pool);
+    TEST_ASSERT(total == long(n) * (n - 1));
+
+    List<int> ordered = list.sorted();
+    list.parallelSort(pool);
+    TEST_ASSERT(list == ordered);
+
+    Set<int> set;
+    for (int i = 0; i < n; ++i) set.insert(random.get(0, n));
+    std::atomic<long> count { 0 };
+    set.parallelForEach([&](int) { ++count; }, pool);
+    TEST_ASSERT(count == set.count());
+    TEST_ASSERT(set.parallelReduce(-1, [](int x) { return x; }, [](int a, int b) { return a < b ? b : a; }, pool) == set.last());
+
+    Map<int, int> map;
+    for (int i = 0; i < 1000; ++i) map.insert(i, i);
+    TEST_ASSERT(map.parallelReduce(0L, [](const auto &item) { return long(item.value()); }, [](long a, long b) { return a + b; }) == 999 * 500);
+}
+
+TEST_CASE("cc_container_reclaimer", "[cc]")
+{
+    static std::atomic<long> alive { 0 };
+
+    struct Tracked {
+        Tracked(int x = 0): x_{x} { ++alive; }
+        Tracked(const Tracked &b): x_{b.x_} { ++alive; }
+        ~Tracked() { --alive; }
+        Tracked &operator=(const Tracked &b) = default;
+        int x_;
+    };
+
+    const int n = 10000;
+
+    Reclaimer::setMode(ReclaimMode::Incremental, 1000);
+    {
+        List<Tracked> list;
+        for (int i = 0; i < n; ++i) list.append(i);
+        List<Tracked> small;
+        for (int i = 0; i < 10; ++i) small.append(i);
+    }
+    TEST_ASSERT(Reclaimer::pendingCount() == 1);
+    TEST_ASSERT(alive == n);
+    long ticks = 0;
+    while (Reclaimer::pendingCount() > 0) {
+        TEST_ASSERT(Reclaimer::tick(8) <= 8);
+        ++ticks;
+    }
+    TEST_ASSERT(ticks > 1);
+    TEST_ASSERT(alive == 0);
+
+    Reclaimer::setMode(ReclaimMode::Background, 1000);
+    for (int k = 0; k < 10; ++k) {
+        Set<int> set;
+        for (int i = 0; i < n; ++i) set.insert(i * k);
+    }
+    {
+        List<Tracked> list;
+        for (int i = 0; i < n; ++i) list.append(i);
+    }
+    Reclaimer::flush();
+    TEST_ASSERT(Reclaimer::pendingCount() == 0);
+    TEST_ASSERT(alive == 0);
+
+    Reclaimer::setMode(ReclaimMode::Incremental, 1000);
+    {
+        List<Tracked> list;
+        for (int i = 0; i < n; ++i) list.append(i);
+    }
+    Reclaimer::setMode(ReclaimMode::Inline);
+    TEST_ASSERT(Reclaimer::pendingCount() == 0);
+    TEST_ASSERT(alive == 0);
+}
+
 TEST_CASE("cc_list_copy_on_write", "[cc]")
 {
     List<int> a;
@@ -96,6 +256,783 @@ TEST_CASE("cc_list_copy_on_write", "[cc]")
     TEST_ASSERT(sizeof(List<int>) == sizeof(void *));
 }
 
+TEST_CASE("cc_container_lazy_allocation", "[cc]")
+{
+    List<int> a, b;
+    TEST_ASSERT(&a.tree() == &b.tree()); // both still refer to the shared empty sentinel
+    TEST_ASSERT(a.count() == 0 && !a.has(0) && a == b);
+
+    List<int> c = a;
+    c << 1;
+    TEST_ASSERT(&c.tree() != &a.tree() && a.count() == 0 && c.count() == 1);
+
+    List<int> d = std::move(c);
+    TEST_ASSERT(c.count() == 0 && d.count() == 1);
+    c << 2;
+    TEST_ASSERT(c.count() == 1 && c.at(0) == 2);
+    c = a;
+    TEST_ASSERT(c.count() == 0);
+
+    Map<int, int> map, other;
+    TEST_ASSERT(&map.tree() == &other.tree() && !map.contains(0));
+    map(1) = 2;
+    TEST_ASSERT(map.count() == 1 && other.count() == 0);
+
+    HashMap<int, int> hashMap;
+    TEST_ASSERT(hashMap.count() == 0 && !hashMap.contains(1) && hashMap.value(1, -1) == -1);
+    hashMap(1) = 2;
+    TEST_ASSERT(hashMap.value(1) == 2);
+
+    String s, t = s;
+    TEST_ASSERT(s.count() == 0 && t.count() == 0);
+    s = "x";
+    TEST_ASSERT(s == "x" && t.count() == 0);
+    Bytes bytes;
+    bytes = Bytes::allocate(1);
+    TEST_ASSERT(bytes.count() == 1 && Bytes{}.count() == 0);
+}
+
+TEST_CASE("cc_list_bulk_load", "[cc]")
+{
+    for (int n: { 1, 15, 16, 17, 256, 1000, 4097 }) {
+        Array<int> array = Array<int>::allocate(n);
+        for (int i = 0; i < n; ++i) array[i] = i;
+
+        List<int> list(array.begin(), array.end());
+
+        TEST_ASSERT(list.count() == n);
+        TEST_ASSERT(list.tree().isDense());
+
+        bool contentOk = true;
+        for (int i = 0; i < n; ++i) {
+            contentOk = contentOk && (list.at(i) == i);
+        }
+        TEST_ASSERT(contentOk);
+
+        list.insertAt(n / 2, -1);
+        list.append(n);
+        TEST_ASSERT(list.count() == n + 2);
+        TEST_ASSERT(list.at(n / 2) == -1);
+        TEST_ASSERT(list.last() == n);
+    }
+
+    static_assert(!std::is_constructible_v<List<long>, int, int>);
+    static_assert(!std::is_constructible_v<Set<long>, int, int>);
+    static_assert(!std::is_constructible_v<HashSet<long>, int, int>);
+}
+
+TEST_CASE("cc_list_insert_range", "[cc]")
+{
+    const int n = 1000;
+
+    List<int> reference;
+    List<int> list;
+    Random random{0};
+
+    for (int k: { 1, 3, 16, 40, 300, 2000 }) {
+        Array<int> chunk = Array<int>::allocate(k);
+        for (int i = 0; i < k; ++i) chunk[i] = random.get(0, n);
+
+        long index = random.get(0, list.count());
+        list.insertRangeAt(index, chunk);
+        for (int i = 0; i < k; ++i) reference.insertAt(index + i, chunk[i]);
+
+        TEST_ASSERT(list == reference);
+        TEST_ASSERT(list.tree().checkBalance());
+    }
+
+    for (int m = 0; m < 500; ++m) {
+        const int k = random.get(1, 5);
+        Array<int> chunk = Array<int>::allocate(k);
+        for (int i = 0; i < k; ++i) chunk[i] = random.get(0, n);
+
+        long index = random.get(0, list.count());
+        list.insertRangeAt(index, chunk);
+        for (int i = 0; i < k; ++i) reference.insertAt(index + i, chunk[i]);
+
+        TEST_ASSERT(list.tree().checkBalance());
+    }
+    TEST_ASSERT(list == reference);
+
+    List<int> a { 1, 2, 3 };
+    a.prependList(a);
+    a.appendList(List<int>{ 4, 5 });
+    TEST_ASSERT((a == List<int>{ 1, 2, 3, 1, 2, 3, 4, 5 }));
+
+    List<int> b { 1, 2 };
+    b.insertRangeAt(1, b);
+    b.insertRangeAt(2, std::vector<int>{ 7, 8 });
+    TEST_ASSERT((b == List<int>{ 1, 1, 7, 8, 2, 2 }));
+}
+
+TEST_CASE("cc_list_remove_range", "[cc]")
+{
+    const int n = 5000;
+
+    List<int> reference;
+    for (int i = 0; i < n; ++i) reference << i;
+
+    List<int> list = reference;
+    Random random{0};
+
+    while (list.count() > 0) {
+        long i0 = random.get(0, list.count() - 1);
+        long i1 = i0 + 1 + random.get(0, (list.count() - i0) / 2);
+
+        list.removeRange(i0, i1);
+        for (long i = i0; i < i1; ++i) reference.removeAt(i0);
+
+        TEST_ASSERT(list == reference);
+    }
+}
+
+TEST_CASE("cc_list_split_concat", "[cc]")
+{
+    const int n = 3000;
+
+    List<int> list;
+    for (int i = 0; i < n; ++i) list << i;
+
+    for (long index: { 0, 1, 17, 256, 1500, 2999, 3000 }) {
+        List<int> head = list;
+        List<int> tail = head.splitAt(index);
+        TEST_ASSERT(head.count() == index);
+        TEST_ASSERT(tail.count() == n - index);
+        if (index > 0) TEST_ASSERT(head.last() == index - 1);
+        if (index < n) TEST_ASSERT(tail.first() == index);
+        TEST_ASSERT(tail.tree().checkBalance());
+
+        head.concat(std::move(tail));
+        TEST_ASSERT(tail.count() == 0);
+        TEST_ASSERT(head == list);
+        TEST_ASSERT(head.tree().checkBalance());
+    }
+
+    List<int> rotated = list;
+    long offset = 0;
+    for (long k = 1; k <= 200; ++k) {
+        const long index = (k * 997) % n;
+        List<int> tail = rotated.splitAt(index);
+        tail.concat(std::move(rotated));
+        rotated = std::move(tail);
+        offset = (offset + index) % n;
+        TEST_ASSERT(rotated.tree().checkBalance());
+    }
+    TEST_ASSERT(rotated.count() == n);
+    bool rotationOk = true;
+    for (int i = 0; i < n; ++i) rotationOk = rotationOk && rotated.at(i) == (offset + i) % n;
+    TEST_ASSERT(rotationOk);
+
+    List<int> a { 1, 2 };
+    a.concat(List<int>{ 3 });
+    a.concat(std::move(list));
+    TEST_ASSERT(a.count() == n + 3);
+    TEST_ASSERT(a.at(2) == 3 && a.at(3) == 0 && a.last() == n - 1);
+}
+
+TEST_CASE("cc_list_reverse", "[cc]")
+{
+    for (int n: { 0, 1, 2, 17, 1000, 4097 }) {
+        List<int> list;
+        for (int i = 0; i < n; ++i) list << i;
+
+        list.reverse();
+        TEST_ASSERT(list.count() == n);
+        for (int i = 0; i < n; ++i) TEST_ASSERT(list.at(i) == n - i - 1);
+
+        list.insertAt(n / 2, -1);
+        list.append(n);
+        TEST_ASSERT(list.at(n / 2) == -1);
+        TEST_ASSERT(list.last() == n);
+
+        list.reverse();
+        TEST_ASSERT(list.first() == n);
+        TEST_ASSERT(list.reversed().last() == n);
+    }
+}
+
+TEST_CASE("cc_list_clone", "[cc]")
+{
+    const int n = 5000;
+
+    List<int> a;
+    List<std::pair<int, std::vector<int>>> b;
+    Random random{0};
+    for (int i = 0; i < n; ++i) {
+        long index = random.get(0, a.count() + 1);
+        a.insertAt(index, i);
+        b.insertAt(index, std::pair<int, std::vector<int>>{i, { i }});
+    }
+    for (int i = 0; i < n / 2; ++i) {
+        long index = random.get(0, a.count());
+        a.removeAt(index);
+        b.removeAt(index);
+    }
+
+    List<int> a2 = a;
+    List<std::pair<int, std::vector<int>>> b2 = b;
+    a2.append(-1);
+    b2.append(std::pair<int, std::vector<int>>{-1, {}});
+    a2.removeAt(a2.count() - 1);
+    b2.removeAt(b2.count() - 1);
+
+    TEST_ASSERT(a2 == a);
+    TEST_ASSERT(a2.tree().checkBalance() == a.tree().checkBalance());
+    TEST_ASSERT(a2.tree().isDense() == a.tree().isDense());
+    TEST_ASSERT(b2.count() == b.count());
+    for (long i = 0; i < b.count(); ++i) {
+        TEST_ASSERT(b2.at(i) == b.at(i) && b2.at(i).second.at(0) == b2.at(i).first);
+    }
+    for (long i = 0; i < a.count(); i += 97) {
+        TEST_ASSERT(a2.at(a2.head() + i) == a.at(i));
+    }
+
+    std::vector<int> r { a.begin(), a.end() };
+    for (int i = 0; i < n; ++i) {
+        long index = random.get(0, a2.count() + 1);
+        a2.insertAt(index, i);
+        r.insert(r.begin() + index, i);
+        index = random.get(0, a2.count());
+        a2.removeAt(index);
+        r.erase(r.begin() + index);
+    }
+    TEST_ASSERT(a2.count() == static_cast<long>(r.size()));
+    for (long i = 0; i < a2.count(); ++i) TEST_ASSERT(a2.at(i) == r[i]);
+}
+
+TEST_CASE("cc_container_move_only", "[cc]")
+{
+    using Pointer = std::unique_ptr<int>;
+
+    const int n = 1000;
+
+    List<Pointer> list;
+    for (int i = 0; i < n; ++i) {
+        Pointer p = std::make_unique<int>(i);
+        if (i % 2 == 0) list.append(std::move(p));
+        else list.insertAt(0, std::move(p));
+        TEST_ASSERT(!p);
+    }
+    list.emplaceBack(new int{n});
+    TEST_ASSERT(list.count() == n + 1);
+    TEST_ASSERT(*list.at(0) == n - 1 && *list.at(n - 1) == n - 2 && *list.at(n) == n);
+    {
+        Pointer p;
+        list >> p;
+        TEST_ASSERT(p && *p == n - 1);
+        TEST_ASSERT(list.count() == n);
+    }
+
+    Set<Pointer> set;
+    for (int i = 0; i < n; ++i) {
+        Pointer p = std::make_unique<int>(i);
+        TEST_ASSERT(set.insert(std::move(p)));
+        TEST_ASSERT(!p);
+    }
+    TEST_ASSERT(set.count() == n);
+    for (long i = 1; i < set.count(); ++i) {
+        TEST_ASSERT(set.at(i - 1).get() < set.at(i).get());
+    }
+
+    Map<int, Pointer> map;
+    for (int i = 0; i < n; ++i) {
+        int key = (i * 7919) % n;
+        Pointer p = std::make_unique<int>(-key);
+        TEST_ASSERT(map.insert(std::move(key), std::move(p)));
+        TEST_ASSERT(!p);
+    }
+    {
+        Pointer p = std::make_unique<int>(1);
+        TEST_ASSERT(!map.insert(0, std::move(p)));
+        TEST_ASSERT(p); // left untouched, because the key already existed
+    }
+    map(n) = std::make_unique<int>(-n);
+    TEST_ASSERT(map.count() == n + 1);
+    for (int i = 0; i <= n; ++i) {
+        TEST_ASSERT(map.at(i).key() == i && *map.at(i).value() == -i);
+    }
+
+    MultiMap<int, Pointer> multiMap;
+    for (int i = 0; i < n; ++i) {
+        multiMap.insert(i % 10, std::make_unique<int>(i));
+    }
+    for (int i = 0; i < n; ++i) {
+        TEST_ASSERT(multiMap.at(i).key() == i / (n / 10));
+        TEST_ASSERT(*multiMap.at(i).value() == (i % (n / 10)) * 10 + i / (n / 10));
+    }
+
+    Queue<Pointer> queue;
+    for (int i = 0; i < n; ++i) {
+        queue.pushBack(std::make_unique<int>(i));
+    }
+    for (int i = 0; i < n; ++i) {
+        Pointer p;
+        queue >> p;
+        TEST_ASSERT(p && *p == i);
+    }
+    TEST_ASSERT(queue.count() == 0);
+}
+
+TEST_CASE("cc_list_compact", "[cc]")
+{
+    const int n = 10000;
+
+    Random random{0};
+
+    auto fragment = [&](List<int> &list, List<int> &reference) {
+        for (int i = 0; i < n; ++i) {
+            long index = random.get(0, list.count() + 1);
+            list.insertAt(index, i);
+            reference.insertAt(index, i);
+        }
+        while (list.count() > n / 2) {
+            long index = random.get(0, list.count());
+            list.removeAt(index);
+            reference.removeAt(index);
+        }
+        TEST_ASSERT(!list.tree().isDense());
+    };
+
+    List<int> a, ra;
+    fragment(a, ra);
+    TEST_ASSERT(a.compact() > 0);
+    TEST_ASSERT(a.tree().isDense());
+    TEST_ASSERT(a == ra);
+    TEST_ASSERT(a.compact() == 0);
+
+    List<int> b, rb;
+    fragment(b, rb);
+    long cursor = 0;
+    long saved = 0;
+    int steps = 0;
+    while (cursor < b.count()) {
+        saved += b.compact(&cursor, 4);
+        TEST_ASSERT(b == rb);
+        ++steps;
+    }
+    TEST_ASSERT(saved > 0 && steps > 1);
+    TEST_ASSERT(b.tree().isDense());
+
+    for (int i = 0; i < 1000; ++i) {
+        long index = random.get(0, b.count() + 1);
+        b.insertAt(index, i);
+        rb.insertAt(index, i);
+        index = random.get(0, b.count());
+        b.removeAt(index);
+        rb.removeAt(index);
+    }
+    TEST_ASSERT(b == rb);
+
+    Set<int> set;
+    for (int i = 0; i < n; ++i) set.insert(random.get(0, 2 * n));
+    for (int i = 0; i < n; ++i) set.remove(static_cast<int>(random.get(0, 2 * n)));
+    List<int> items { set.begin(), set.end() };
+    TEST_ASSERT(set.compact() > 0 && set.isDense());
+    for (long i = 0; i < items.count(); ++i) TEST_ASSERT(set.at(i) == items.at(i) && set.contains(items.at(i)));
+}
+
+/** Integer whose tree nodes are allocated from the thread-local node pools
+  */
+struct PooledInt
+{
+    int value;
+
+    std::strong_ordering operator<=>(const PooledInt &other) const = default;
+};
+
+template<>
+struct cc::blist::StoragePolicy<PooledInt>: public cc::blist::DefaultStoragePolicy<PooledInt>
+{
+    using Allocator = cc::blist::PoolAllocator;
+};
+
+TEST_CASE("cc_pool_allocator", "[cc]")
+{
+    using Leaf = List<PooledInt>::Tree::Leaf;
+    using Branch = List<PooledInt>::Tree::Branch;
+
+    auto &pool = *blist::PoolAllocator::pool<Leaf>();
+    const long slabsBefore = pool.slabCount();
+
+    const int n = 5000;
+    Random random{0};
+
+    List<PooledInt> list;
+    List<int> reference;
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < n; ++i) {
+            long index = random.get(0, list.count() + 1);
+            list.insertAt(index, PooledInt{i});
+            reference.insertAt(index, i);
+        }
+        for (int i = 0; i < n / 2; ++i) {
+            long index = random.get(0, list.count());
+            list.removeAt(index);
+            reference.removeAt(index);
+        }
+    }
+
+    auto contentOk = [&]{
+        bool ok = list.count() == reference.count();
+        for (long i = 0; ok && i < list.count(); ++i) ok = list.at(i).value == reference.at(i);
+        return ok;
+    };
+
+    TEST_ASSERT(contentOk());
+    TEST_ASSERT(pool.slabCount() > slabsBefore);
+
+    while (list.count() > n / 4) {
+        long index = random.get(0, list.count());
+        list.removeAt(index);
+        reference.removeAt(index);
+    }
+    const long slabsFragmented = pool.slabCount();
+    TEST_ASSERT(list.compact() > 0);
+    TEST_ASSERT(pool.slabCount() < slabsFragmented);
+    TEST_ASSERT(contentOk());
+
+    {
+        List<PooledInt> snapshot = list;
+        list.append(PooledInt{-1});
+        reference.append(-1);
+        std::thread{[&snapshot]{ snapshot.deplete(); }}.join();
+    }
+    TEST_ASSERT(contentOk());
+
+    blist::PoolAllocator::trim<Leaf>();
+    blist::PoolAllocator::trim<Branch>();
+    const long slabsShared = pool.slabCount();
+    list.deplete();
+    TEST_ASSERT(pool.slabCount() < slabsShared);
+    TEST_ASSERT(pool.slabCount() == slabsBefore);
+
+    {
+        List<PooledInt> orphaned;
+        std::thread{[&orphaned]{ for (int i = 0; i < n; ++i) orphaned.append(PooledInt{i}); }}.join();
+        TEST_ASSERT(orphaned.count() == n && orphaned.at(n - 1).value == n - 1);
+    }
+    blist::PoolAllocator::trim<Leaf>();
+    blist::PoolAllocator::trim<Branch>();
+    TEST_ASSERT(pool.slabCount() == slabsBefore);
+}
+
+TEST_CASE("cc_locator_seek", "[cc]")
+{
+    const int n = 5000;
+
+    List<int> list;
+    Queue<int> queue;
+    for (int i = 0; i < n; ++i) {
+        list.insertAt(list.count() / 2, i);
+        queue.pushFront(i);
+        queue.pushBack(i);
+    }
+
+    Random random{0};
+    for (int k = 0; k < 1000; ++k) {
+        long i = random.get(0, list.count());
+        long j = random.get(0, list.count());
+        Locator a = list.head() + i;
+        Locator b = a + (j - i);
+        TEST_ASSERT(a.index() == i && list.at(a) == list.at(i));
+        TEST_ASSERT(b.index() == j && list.at(b) == list.at(j));
+
+        i = random.get(0, queue.count());
+        j = random.get(0, queue.count());
+        a = queue.head() + i;
+        b = a + (j - i);
+        TEST_ASSERT(a.index() == i && queue.at(a) == (i < n ? n - i - 1 : i - n));
+        TEST_ASSERT(b.index() == j && queue.at(b) == (j < n ? n - j - 1 : j - n));
+    }
+
+    TEST_ASSERT(!(list.head() + list.count()));
+    TEST_ASSERT(!(list.tail() - list.count()));
+    TEST_ASSERT(!(queue.head() + queue.count()));
+    TEST_ASSERT(!(queue.tail() - queue.count()));
+}
+
+TEST_CASE("cc_list_compact_bytes", "[cc]")
+{
+    const int n = 5000;
+
+    static_assert(blist::StoragePolicy<char>::IsCompact);
+    TEST_ASSERT(sizeof(List<char>::Tree::Leaf) < sizeof(List<char>::Tree::Node) + 2 * blist::StoragePolicy<char>::Granularity);
+
+    List<char> reference;
+    List<uint8_t> list;
+    Random random{0};
+
+    for (int i = 0; i < n; ++i) {
+        uint8_t ch = random.get(0, 256);
+        long index = random.get(0, list.count());
+        list.insertAt(index, ch);
+        reference.insertAt(index, static_cast<char>(ch));
+    }
+
+    while (list.count() > n / 2) {
+        long index = random.get(0, list.count() - 1);
+        list.removeAt(index);
+        reference.removeAt(index);
+    }
+
+    TEST_ASSERT(list.count() == reference.count());
+    for (long i = 0; i < list.count(); ++i) {
+        TEST_ASSERT(list.at(i) == static_cast<uint8_t>(reference.at(i)));
+    }
+
+    List<char> tail = reference.splitAt(reference.count() / 3);
+    reference.concat(std::move(tail));
+    reference.removeRange(10, 1000);
+    TEST_ASSERT(reference.count() == list.count() - 990);
+    TEST_ASSERT(reference.at(10) == static_cast<char>(list.at(1000)));
+
+    static_assert(List<char>::Tree::Fanout <= blist::MaxFanout);
+    List<char> bytes;
+    for (int i = 0; i < 40 * n; ++i) bytes << static_cast<char>(i);
+    TEST_ASSERT(bytes.tree().isDense());
+    for (int i = 0; i < 40 * n; i += 7) TEST_ASSERT(bytes.at(i) == static_cast<char>(i));
+    for (int i = 0; i < n; ++i) bytes.insertAt(random.get(0, bytes.count()), 0);
+    TEST_ASSERT(bytes.count() == 41 * n && !bytes.tree().isDense());
+}
+
+TEST_CASE("cc_multiset_equal_range", "[cc]")
+{
+    MultiSet<int> set;
+    for (int i = 0; i < 1000; ++i) set.insert(i % 10);
+
+    long i0 = 0, i1 = 0;
+    TEST_ASSERT(set.equalRange(3, &i0, &i1));
+    TEST_ASSERT(i0 == 300 && i1 == 400);
+    TEST_ASSERT(set.countOf(3) == 100);
+    TEST_ASSERT(!set.equalRange(10, &i0, &i1));
+    TEST_ASSERT(i0 == 1000 && i1 == 1000);
+
+    TEST_ASSERT(set.remove(3) == 100);
+    TEST_ASSERT(set.count() == 900);
+    TEST_ASSERT(set.countOf(3) == 0);
+    TEST_ASSERT(set.countOf(2) == 100 && set.countOf(4) == 100);
+    TEST_ASSERT(set.at(299) == 2 && set.at(300) == 4);
+
+    MultiMap<int> map;
+    for (int i = 0; i < 100; ++i) map.insert(i % 7, i);
+    TEST_ASSERT(map.remove(6) == 14);
+    TEST_ASSERT(map.count() == 86);
+    TEST_ASSERT(!map.contains(6));
+}
+
+TEST_CASE("cc_set_bulk_load", "[cc]")
+{
+    const int n = 1000;
+
+    List<int> ascending;
+    for (int i = 0; i < n; ++i) ascending << i << i;
+
+    Set<int> a(ascending.begin(), ascending.end());
+    TEST_ASSERT(a.count() == n);
+    TEST_ASSERT(a.isDense());
+    for (int i = 0; i < n; ++i) TEST_ASSERT(a.at(i) == i);
+
+    MultiSet<int> b(ascending.begin(), ascending.end());
+    TEST_ASSERT(b.count() == 2 * n);
+
+    List<int> shuffled = ascending;
+    Random{0}.shuffle(shuffled);
+
+    Set<int> c(shuffled.begin(), shuffled.end());
+    TEST_ASSERT(c == a);
+
+    Map<int> d { { 2, 1 }, { 1, 0 }, { 2, 3 }, { 3, 4 } };
+    TEST_ASSERT(d.count() == 3);
+    TEST_ASSERT(d.value(2) == 1);
+}
+
+TEST_CASE("cc_set_insert_hinted", "[cc]")
+{
+    const int n = 1000;
+
+    Set<int> a;
+    Locator pos;
+    for (int i = 0; i < n; ++i) {
+        TEST_ASSERT(a.insert(pos, i, &pos));
+        TEST_ASSERT(pos.index() == i && a.at(pos) == i);
+    }
+    TEST_ASSERT(a.count() == n);
+    TEST_ASSERT(a.isDense());
+
+    Set<int> b;
+    pos = Locator{};
+    for (int i = n - 1; i >= 0; --i) {
+        TEST_ASSERT(b.insert(pos, i, &pos));
+        TEST_ASSERT(pos.index() == 0 && b.at(pos) == i);
+    }
+    TEST_ASSERT(b == a);
+
+    Set<int> c;
+    Random random{0};
+    for (int i = 0; i < n; ++i) {
+        int x = random.get(0, 2 * n);
+        Locator hint = c.count() > 0 ? c.head() + random.get(0, c.count()) : Locator{};
+        bool isNew = !c.contains(x);
+        TEST_ASSERT(c.insert(hint, x, &pos) == isNew);
+        Locator target;
+        TEST_ASSERT(c.find(x, &target));
+        TEST_ASSERT(c.at(pos) == x && pos.index() == target.index());
+    }
+    for (long i = 1; i < c.count(); ++i) TEST_ASSERT(c.at(i - 1) < c.at(i));
+
+    Map<int> m;
+    pos = Locator{};
+    for (int i = 0; i < n; ++i) TEST_ASSERT(m.insert(pos, i, -i, &pos));
+    TEST_ASSERT(!m.insert(m.head() + n / 2, n / 2, 0));
+    for (int i = 0; i < n; ++i) TEST_ASSERT(m.value(i) == -i);
+}
+
+TEST_CASE("cc_set_algebra", "[cc]")
+{
+    auto check = [](const Set<int> &a, const Set<int> &b, const Set<int> &c, int range, auto &&expected) {
+        long n = 0;
+        for (int x = 0; x < range; ++x) {
+            const bool member = expected(a.contains(x), b.contains(x));
+            TEST_ASSERT(c.contains(x) == member);
+            n += member;
+        }
+        TEST_ASSERT(c.count() == n);
+        for (long i = 1; i < c.count(); ++i) TEST_ASSERT(c.at(i - 1) < c.at(i));
+    };
+
+    for (int n: { 0, 1, 100, 3000 }) {
+        for (int m: { 0, 3, 100, 3000 }) {
+            const int range = 2 * (n + m) + 1;
+            Random random{static_cast<uint32_t>(n + m)};
+            Set<int> a, b;
+            for (int i = 0; i < n; ++i) a.insert(random.get(0, range));
+            for (int i = 0; i < m; ++i) b.insert(random.get(0, range));
+
+            check(a, b, a.united(b), range, [](bool x, bool y) { return x || y; });
+            check(a, b, a.intersected(b), range, [](bool x, bool y) { return x && y; });
+            check(a, b, a.subtracted(b), range, [](bool x, bool y) { return x && !y; });
+            check(a, b, a.symmetricDifference(b), range, [](bool x, bool y) { return x != y; });
+
+            Set<int> c;
+            c = a; c.unite(b); TEST_ASSERT(c == a.united(b));
+            c = a; c.intersect(b); TEST_ASSERT(c == a.intersected(b));
+            c = a; c.subtract(b); TEST_ASSERT(c == a.subtracted(b));
+            c = a; c.symmetricSubtract(b); TEST_ASSERT(c == a.symmetricDifference(b));
+
+            c = Set<int>{a.begin(), a.end()}; c.unite(b); TEST_ASSERT(c == a.united(b));
+            c = Set<int>{a.begin(), a.end()}; c.intersect(b); TEST_ASSERT(c == a.intersected(b));
+            c = Set<int>{a.begin(), a.end()}; c.subtract(b); TEST_ASSERT(c == a.subtracted(b));
+            c = Set<int>{a.begin(), a.end()}; c.symmetricSubtract(b); TEST_ASSERT(c == a.symmetricDifference(b));
+            TEST_ASSERT(n + m == 0 || a.united(b).isDense());
+        }
+    }
+
+    {
+        const int range = 40000;
+        Set<int> a, b;
+        for (int x = 0; x < range; x += 2) a.insert(x);
+        for (int x = 1; x < range; x = 3 * x / 2 + 1) b << x << x + 1; // gaps from adjacent to many leaves
+        check(a, b, a.united(b), range, [](bool x, bool y) { return x || y; });
+        check(a, b, a.intersected(b), range, [](bool x, bool y) { return x && y; });
+        check(a, b, b.subtracted(a), range, [](bool x, bool y) { return y && !x; });
+        Set<int> c;
+        c = a; c.unite(b); TEST_ASSERT(c == a.united(b));
+        c = a; c.subtract(b); TEST_ASSERT(c == a.subtracted(b));
+        c = a; c.symmetricSubtract(b); TEST_ASSERT(c == a.symmetricDifference(b));
+    }
+
+    Set<int> s { 1, 2, 3 };
+    s.unite(s);
+    TEST_ASSERT(s == (Set<int>{ 1, 2, 3 }));
+    s.subtract(s);
+    TEST_ASSERT(s.count() == 0);
+
+    Map<int, int> x { { 1, 1 }, { 2, 2 }, { 3, 3 } };
+    Map<int, int> y { { 2, -2 }, { 4, -4 } };
+    Map<int, int> z = x.united(y);
+    TEST_ASSERT(z.count() == 4 && z.value(2) == 2 && z.value(4) == -4);
+    TEST_ASSERT(x.intersected(y).count() == 1 && x.intersected(y).value(2) == 2);
+    TEST_ASSERT(y.intersected(x).value(2) == -2);
+
+    MultiSet<int> p { 1, 1, 1, 2, 3 };
+    MultiSet<int> q { 1, 3, 3, 4 };
+    TEST_ASSERT(p.united(q) == (MultiSet<int>{ 1, 1, 1, 2, 3, 3, 4 }));
+    TEST_ASSERT(p.intersected(q) == (MultiSet<int>{ 1, 3 }));
+    TEST_ASSERT(p.subtracted(q) == (MultiSet<int>{ 1, 1, 2 }));
+    TEST_ASSERT(p.symmetricDifference(q) == (MultiSet<int>{ 1, 1, 2, 3, 4 }));
+}
+
+/** Integer stored in tiny tree nodes, so that a few thousand items already make a deep tree
+  */
+struct TinyNodeInt
+{
+    int value;
+
+    std::strong_ordering operator<=>(const TinyNodeInt &other) const = default;
+};
+
+template<>
+struct cc::blist::StoragePolicy<TinyNodeInt>: public cc::blist::DefaultStoragePolicy<TinyNodeInt>
+{
+    static constexpr unsigned Granularity = 4;
+};
+
+template<>
+struct cc::blist::StoragePolicy<KeyValue<TinyNodeInt, int>>: public cc::blist::DefaultStoragePolicy<KeyValue<TinyNodeInt, int>>
+{
+    static constexpr unsigned Granularity = 4;
+};
+
+TEST_CASE("cc_set_deep_lookup", "[cc]")
+{
+    const int n = 2000;
+    const int range = 4 * n;
+    Random random{0};
+    Map<TinyNodeInt, int> map;
+    MultiSet<TinyNodeInt> multiSet;
+    Map<int, int> reference;
+
+    auto check = [&]{
+        TEST_ASSERT(map.tree().height() >= 3 && map.tree().checkHeads());
+        TEST_ASSERT(multiSet.tree().height() >= 3 && multiSet.tree().checkHeads());
+        for (int x = 0; x <= range; ++x) {
+            Locator pos;
+            const bool found = map.find(TinyNodeInt{x}, &pos);
+            TEST_ASSERT(found == reference.contains(x));
+            if (found) TEST_ASSERT(map.at(pos).value() == reference.value(x));
+            long i0 = 0, i1 = 0;
+            TEST_ASSERT(multiSet.equalRange(TinyNodeInt{x}, &i0, &i1) == found);
+            TEST_ASSERT(i1 - i0 == (found ? 1 + (x % 2 == 0) : 0));
+            if (found) TEST_ASSERT(multiSet.at(i0).value == x && multiSet.at(i1 - 1).value == x);
+        }
+        long i = 0;
+        for (const auto &item: reference) TEST_ASSERT(map.at(i++).key().value == item.key());
+    };
+
+    for (int i = 0; i < n; ++i) {
+        const int x = random.get(0, range);
+        if (map.insert(TinyNodeInt{x}, i)) {
+            reference.insert(x, i);
+            multiSet.insert(TinyNodeInt{x});
+            if (x % 2 == 0) multiSet.insert(TinyNodeInt{x});
+        }
+        else {
+            multiSet.insert(TinyNodeInt{-1 - i});
+        }
+    }
+    check();
+
+    for (int i = 0; i < n / 2; ++i) {
+        const int x = random.get(0, range);
+        if (map.remove(TinyNodeInt{x})) {
+            reference.remove(x);
+            multiSet.remove(TinyNodeInt{x});
+            multiSet.insert(TinyNodeInt{-range - i});
+        }
+    }
+    check();
+}
+
 TEST_CASE("cc_map_insert_operator", "[cc]")
 {
     Map<int> m;
@@ -137,6 +1074,278 @@ TEST_CASE("cc_map_insert_remove", "[cc]")
     TEST_ASSERT(map.count() == 0);
 }
 
+TEST_CASE("cc_map_upsert", "[cc]")
+{
+    const int n = 1000;
+
+    Map<int, int> counts;
+    std::vector<int> expected(n / 10, 0);
+    Random random{0};
+    for (int i = 0; i < n; ++i) {
+        int key = random.get(0, n / 10 - 1);
+        bool inserted = counts.update(key, [](int &count){ ++count; });
+        TEST_ASSERT(inserted == (expected[key] == 0));
+        ++expected[key];
+    }
+    for (const auto &item: counts) {
+        TEST_ASSERT(item.value() == expected[item.key()]);
+    }
+
+    Map<int, std::vector<int>> lists;
+    TEST_ASSERT(lists.tryEmplace(1, 3, 7));
+    TEST_ASSERT(!lists.tryEmplace(1, 5, 7));
+    TEST_ASSERT(lists.value(1) == (std::vector<int>{3, 7}));
+
+    int calls = 0;
+    auto make = [&]{ ++calls; return std::vector<int>{calls}; };
+    lists.computeIfAbsent(2, make).push_back(-1);
+    lists.computeIfAbsent(2, make).push_back(-2);
+    TEST_ASSERT(calls == 1);
+    TEST_ASSERT(lists.value(2) == (std::vector<int>{1, -1, -2}));
+
+    TEST_ASSERT(!lists.insertOrAssign(1, std::vector<int>{}));
+    TEST_ASSERT(lists.insertOrAssign(3, std::vector<int>{3}));
+    TEST_ASSERT(lists.count() == 3 && lists.value(1).size() == 0 && lists.value(3).at(0) == 3);
+
+    Map<std::vector<int>, int> byVector;
+    std::vector<int> a{1, 2}, b{3, 4}, c{5, 6};
+    const int *buffers[] = { a.data(), b.data(), c.data() };
+    byVector.establish(std::move(a), 1);
+    TEST_ASSERT(byVector.insertOrAssign(std::move(b), 2));
+    TEST_ASSERT(byVector.tryEmplace(std::move(c), 3));
+    for (int i = 0; i < 3; ++i) TEST_ASSERT(byVector.at(i).key().data() == buffers[i]); // keys were moved, not copied
+
+    MultiMap<int, int> multiMap;
+    multiMap.insert(1, 1);
+    multiMap.insert(1, 2);
+    TEST_ASSERT(!multiMap.tryEmplace(1, 3));
+    TEST_ASSERT(multiMap.tryEmplace(0, 3));
+    TEST_ASSERT(!multiMap.insertOrAssign(1, 10));
+    TEST_ASSERT(!multiMap.update(1, [](int &value){ value += 1; }));
+    TEST_ASSERT(multiMap.computeIfAbsent(2, []{ return 20; }) == 20);
+    TEST_ASSERT(multiMap.count() == 4);
+    TEST_ASSERT(multiMap.at(0).value() == 3 && multiMap.at(1).value() == 11 && multiMap.at(2).value() == 2 && multiMap.at(3).value() == 20);
+}
+
+TEST_CASE("cc_hash_function", "[cc]")
+{
+    TEST_ASSERT(hash(Bytes{}) == 0xEF46DB3751D8E999ULL);
+    TEST_ASSERT(hash(String{"abc"}) == 0x44BC2CF5AD770999ULL);
+    TEST_ASSERT(hash(String{"Nobody inspects the spammish repetition"}) == 0xFBCEA83C8A378BF1ULL);
+
+    String text = String::allocate(1000);
+    for (long i = 0; i < text.count(); ++i) text[i] = 'A' + i % 61;
+    for (long n: { 0, 1, 7, 31, 32, 33, 100, 1000 }) {
+        String head = text.copy(0, n);
+        for (long split: { 0L, 1L, 5L, 32L, 63L, n / 2, n }) {
+            if (split > n) continue;
+            Hasher hasher;
+            hasher.feed(head.chars(), split).feed(head.chars() + split, n - split);
+            TEST_ASSERT(hasher.finish() == hash(head));
+            Hasher casefree{0, true};
+            casefree.feed(head.chars(), split).feed(head.chars() + split, n - split);
+            TEST_ASSERT(casefree.finish() == hash(head.downcased()));
+        }
+        TEST_ASSERT(hash(Casefree<String>{head}) == hash(head.downcased()));
+        TEST_ASSERT(hash(head, 1) != hash(head));
+    }
+
+    for (long n: { 100, 0x10000 }) {
+        Hasher hasher;
+        TEST_ASSERT(hasher.feedFrom(NullStream{}, n) == n);
+        Bytes zeros = Bytes::allocate(n);
+        zeros.fill(0);
+        TEST_ASSERT(hasher.finish() == hash(zeros));
+    }
+}
+
+TEST_CASE("cc_hash_set", "[cc]")
+{
+    const int n = 10000;
+
+    HashSet<int> set;
+    Set<int> expected;
+    Random random{0};
+    for (int i = 0; i < n; ++i) {
+        int x = random.get(0, n / 4);
+        if (i % 3 == 0) TEST_ASSERT(set.remove(x) == expected.remove(x));
+        else TEST_ASSERT(set.insert(x) == expected.insert(x));
+    }
+    TEST_ASSERT(set.table().check());
+    TEST_ASSERT(set.count() == expected.count());
+    for (int x: set) TEST_ASSERT(expected.contains(x));
+    for (int x: expected) TEST_ASSERT(set.contains(x));
+
+    HashSet<int> copy = set;
+    copy.remove(expected.first());
+    TEST_ASSERT(copy.count() == set.count() - 1 && set.contains(expected.first()));
+    copy.insert(expected.first());
+    TEST_ASSERT(copy == set);
+
+    for (int x: expected) set.remove(x);
+    TEST_ASSERT(set.count() == 0 && set.table().check());
+
+    HashSet<Casefree<String>> names { "Alice", "bob" };
+    TEST_ASSERT(!names.insert("ALICE"));
+    TEST_ASSERT(names.contains("BoB") && !names.contains("carol"));
+    TEST_ASSERT(names.count() == 2);
+
+    using Table = std::remove_cvref_t<decltype(names.table())>;
+    Table a = names.table();
+    Table b;
+    b = a;
+    a = Table{};
+    Table c{std::move(b)};
+    TEST_ASSERT(a.count() == 0 && b.count() == 0 && c.count() == 2 && c.check());
+    TEST_ASSERT(c.lookup(Casefree<String>{"alice"}) >= 0);
+}
+
+TEST_CASE("cc_hash_map", "[cc]")
+{
+    const int n = 2000;
+
+    HashMap<String, int> map;
+    Map<String, int> expected;
+    Random random{0};
+    for (int i = 0; i < n; ++i) {
+        String key = str(random.get(0, n / 2));
+        if (i % 4 == 0) TEST_ASSERT(map.remove(key) == expected.remove(key));
+        else if (i % 4 == 1) TEST_ASSERT(map.insert(key, i) == expected.insert(key, i));
+        else {
+            map(key) += 1;
+            expected(key) += 1;
+        }
+    }
+    TEST_ASSERT(map.table().check());
+    TEST_ASSERT(map.count() == expected.count());
+    for (const auto &item: expected) {
+        int value = 0;
+        TEST_ASSERT(map.lookup(item.key(), &value) && value == item.value());
+    }
+
+    HashMap<String, int> copy = map;
+    for (auto &item: copy) item.value() = -item.value();
+    for (const auto &item: map) TEST_ASSERT(copy.value(item.key()) == -item.value());
+
+    TEST_ASSERT(map.tryEmplace("new", 7) && !map.tryEmplace("new", 8));
+    TEST_ASSERT(!map.insertOrAssign("new", 9) && map.value("new") == 9);
+    TEST_ASSERT(map.computeIfAbsent("other", []{ return 3; }) == 3);
+    TEST_ASSERT(!map.update("other", [](int &value){ value *= 2; }) && map.value("other") == 6);
+    TEST_ASSERT(map.value("missing", -1) == -1);
+}
+
+TEST_CASE("cc_symbol", "[cc]")
+{
+    String text = "content-type";
+    Symbol a{text};
+    Symbol b{String{"content-type; charset", 12}};
+    TEST_ASSERT(a == b && a.id() == b.id() && a.chars() == b.chars());
+    TEST_ASSERT(a.toString() == "content-type" && a.hash() == hash(text));
+    text[0] = 'C';
+    TEST_ASSERT(a.toString() == "content-type");
+
+    TEST_ASSERT(Symbol{} == Symbol{""} && Symbol{}.id() == 0 && Symbol{}.count() == 0);
+    TEST_ASSERT(Symbol{"accept"} != a);
+
+    long n = Symbol::internedCount();
+    Symbol c;
+    TEST_ASSERT(!Symbol::lookup("no-such-symbol", &c) && Symbol::internedCount() == n);
+    TEST_ASSERT(Symbol::lookup("accept", &c) && c == Symbol{"accept"});
+
+    Symbol fresh{"x-freshly-interned"};
+    TEST_ASSERT(Symbol::internedCount() == n + 1 && fresh.id() == Symbol::internedCount());
+
+    List<Symbol> tags;
+    for (const char *tag: { "zeta", "alpha", "mu" }) tags << Symbol{tag};
+
+    Map<Symbol, int, InternOrder> byId;
+    for (const Symbol &tag: tags) byId.insert(tag, 0);
+    TEST_ASSERT(byId.count() == 3);
+    for (int i = 1; i < byId.count(); ++i) TEST_ASSERT(byId.at(i - 1).key().id() < byId.at(i).key().id());
+    TEST_ASSERT(byId.contains(Symbol{"mu"}) && !byId.contains(Symbol{"nu"}));
+
+    Set<Symbol> byText(tags.begin(), tags.end());
+    TEST_ASSERT(byText.first() == Symbol{"alpha"} && byText.last() == Symbol{"zeta"});
+
+    HashSet<Symbol> hashed;
+    for (const Symbol &tag: tags) hashed << tag;
+    TEST_ASSERT(hashed.contains(Symbol{"alpha"}) && hashed.count() == 3);
+}
+
+TEST_CASE("cc_persistent_map", "[cc]")
+{
+    const int n = 5000;
+
+    PersistentMap<int, int> a;
+    Map<int, int> b;
+    List<PersistentMap<int, int>> snapshots;
+    List<Map<int, int>> expected;
+    Random random{0};
+
+    for (int i = 0; i < n; ++i) {
+        const int key = random.get(0, n / 2);
+        if (i % 3 == 0) {
+            TEST_ASSERT(a.remove(key) == b.remove(key));
+        }
+        else if (i % 3 == 1) {
+            TEST_ASSERT(a.insert(key, i) == b.insert(key, i));
+        }
+        else {
+            a(key) += 1;
+            b(key) += 1;
+        }
+        if (i % 500 == 0) {
+            snapshots.append(a.snapshot());
+            expected.append(b);
+        }
+    }
+    snapshots.append(a);
+    expected.append(b);
+
+    for (long k = 0; k < snapshots.count(); ++k) {
+        const PersistentMap<int, int> &s = snapshots.at(k);
+        const Map<int, int> &m = expected.at(k);
+        TEST_ASSERT(s.tree().check());
+        TEST_ASSERT(s.count() == m.count());
+        long i = 0;
+        for (const auto &item: s) {
+            TEST_ASSERT(item.key() == m.at(i).key() && item.value() == m.at(i).value());
+            long index = -1;
+            TEST_ASSERT(s.find(item.key(), &index) && index == i);
+            ++i;
+        }
+    }
+
+    PersistentMap<int, int> c { { 1, 1 }, { 2, 2 } };
+    PersistentMap<int, int> d = c;
+    d.establish(2, -2);
+    d.removeAt(0);
+    TEST_ASSERT(c.value(2) == 2 && c.count() == 2);
+    TEST_ASSERT(d.value(2) == -2 && d.count() == 1);
+    d.deplete();
+    TEST_ASSERT(d.count() == 0 && c.count() == 2);
+
+    PersistentMap<int, String> e;
+    for (int i = 0; i < 2000; ++i) e.insert(i, str(i));
+    PersistentMap<int, String> f = e.snapshot();
+    String value = "moved";
+    TEST_ASSERT(!f.insert(7, std::move(value)) && value == "moved");
+    TEST_ASSERT(f.insert(2000, std::move(value)) && f.value(2000) == "moved");
+    TEST_ASSERT(!f.tryEmplace(3, "x") && f.tryEmplace(-1, "y") && f.value(-1) == "y");
+    TEST_ASSERT(!f.update(5, [](String &s) { s = s + "!"; }) && f.value(5) == "5!");
+    TEST_ASSERT(f.update(3000, [](String &s) { s = "new"; }) && f(3000) == "new");
+    TEST_ASSERT(!f.insertOrAssign(1999, "z") && f.value(1999) == "z");
+    f(1000) = "a";
+    f.establish(1001, "b");
+    TEST_ASSERT(f.tree().check() && e.tree().check() && e.tree().height() >= 2);
+    TEST_ASSERT(f.count() == e.count() + 3);
+    for (int i = 0; i < 2000; ++i) {
+        String s;
+        TEST_ASSERT(e.lookup(i, &s) && s == str(i));
+    }
+    TEST_ASSERT(f.value(1000) == "a" && f.value(1001) == "b" && f.value(1002) == "1002");
+}
+
 TEST_CASE("cc_map_morph_to_list", "[cc]")
 {
     Map<int> map;
@@ -151,6 +1360,7 @@ TEST_CASE("cc_map_morph_to_list", "[cc]")
     }
 
     List<KeyValue<int>> list { std::move(map) };
+    TEST_ASSERT(map.count() == 0);
     {
         Random random { 0 };
         for (int i = 0; i < n; ++i) {
@@ -159,6 +1369,20 @@ TEST_CASE("cc_map_morph_to_list", "[cc]")
             TEST_ASSERT(list.find(KeyValue{key, value}));
         }
     }
+
+    Map<int, String> names;
+    for (int i = 0; i < 5000; ++i) names.insert(i, str(i));
+    Map<int, String> shared = names;
+    List<KeyValue<int, String>> copied { std::move(shared) };
+    TEST_ASSERT(shared.count() == 5000 && copied.count() == 5000);
+    shared = Map<int, String>{};
+    List<KeyValue<int, String>> moved { std::move(names) };
+    TEST_ASSERT(names.count() == 0 && moved.count() == 5000);
+    bool ok = true;
+    for (int i = 0; i < 5000; ++i) ok = ok && moved.at(i).key() == i && moved.at(i).value() == str(i) && copied.at(i).value() == str(i);
+    TEST_ASSERT(ok);
+    moved.insertAt(2500, KeyValue<int, String>{-1, "x"});
+    TEST_ASSERT(moved.count() == 5001 && moved.at(2500).key() == -1);
 }
 
 TEST_CASE("cc_multimap_insert", "[cc]")